@@ -86,6 +86,22 @@ int probe_82802ab(struct flashctx *flash)
 	return 1;
 }
 
+/* Returns 0 if status shows no block erase, program, VPP or lock error. */
+static int check_status_82802ab(struct flashctx *flash, uint8_t status, unsigned int addr)
+{
+	flash->error_status_checked = true;
+	if (!(status & 0x3a))
+		return 0;
+
+	msg_cerr("%s failed at 0x%06x: ", status & 0x20 ? "Erase" : "Program", addr);
+	print_status_82802ab(status);
+	msg_cerr("\n");
+	/* Clear the sticky error bits, they would make all further operations fail. */
+	chip_writeb(flash, 0x50, flash->virtual_memory);
+	chip_writeb(flash, 0xFF, flash->virtual_memory);
+	return -1;
+}
+
 /* FIXME: needs timeout */
 uint8_t wait_82802ab(struct flashctx *flash)
 {
@@ -123,24 +139,39 @@ int erase_block_82802ab(struct flashctx *flash, unsigned int page,
 	status = wait_82802ab(flash);
 	print_status_82802ab(status);
 
-	/* FIXME: Check the status register for errors. */
-	return 0;
+	return check_status_82802ab(flash, status, page);
 }
 
 /* chunksize is 1 */
 int write_82802ab(struct flashctx *flash, const uint8_t *src, unsigned int start, unsigned int len)
 {
 	int i;
-	chipaddr dst = flash->virtual_memory + start;
+	chipaddr bios = flash->virtual_memory;
+	chipaddr dst = bios + start;
+	uint8_t status;
 
-	for (i = 0; i < len; i++) {
+	for (i = 0; i < len; i++, src++, dst++) {
+		/* Programming 0xff doesn't change an erased byte. */
+		if (*src == 0xff)
+			continue;
 		/* transfer data from source to destination */
 		chip_writeb(flash, 0x40, dst);
-		chip_writeb(flash, *src++, dst++);
-		wait_82802ab(flash);
+		chip_writeb(flash, *src, dst);
+		/*
+		 * The chip stays in status mode after a program command, so
+		 * neither 0x70 nor a reset to read array mode is needed
+		 * before the next byte.
+		 */
+		do {
+			status = chip_readb(flash, bios);
+		} while (!(status & 0x80));
+		if (check_status_82802ab(flash, status, start + i))
+			return -1;
 	}
 
-	/* FIXME: Ignore errors for now. */
+	/* Back to read array mode. */
+	chip_writeb(flash, 0xFF, bios);
+
 	return 0;
 }
 
@@ -59,12 +59,13 @@ const struct dev_entry ata_promise[] = {
 
 static void atapromise_chip_writeb(const struct flashctx *flash, uint8_t val, chipaddr addr);
 static uint8_t atapromise_chip_readb(const struct flashctx *flash, const chipaddr addr);
+static void atapromise_chip_readn(const struct flashctx *flash, uint8_t *buf, const chipaddr addr, size_t len);
 
 static const struct par_master par_master_atapromise = {
 		.chip_readb		= atapromise_chip_readb,
 		.chip_readw		= fallback_chip_readw,
 		.chip_readl		= fallback_chip_readl,
-		.chip_readn		= fallback_chip_readn,
+		.chip_readn		= atapromise_chip_readn,
 		.chip_writeb		= atapromise_chip_writeb,
 		.chip_writew		= fallback_chip_writew,
 		.chip_writel		= fallback_chip_writel,
@@ -169,6 +170,20 @@ static uint8_t atapromise_chip_readb(const struct flashctx *flash, const chipadd
 	return pci_mmio_readb(atapromise_bar + (addr & ADDR_MASK));
 }
 
+static void atapromise_chip_readn(const struct flashctx *flash, uint8_t *buf, const chipaddr addr, size_t len)
+{
+	chipaddr pos = addr;
+
+	atapromise_limit_chip(flash->chip);
+	while (len) {
+		const size_t chunk = min(len, ADDR_MASK + 1 - (pos & ADDR_MASK));
+		mmio_readn(atapromise_bar + (pos & ADDR_MASK), buf, chunk);
+		pos += chunk;
+		buf += chunk;
+		len -= chunk;
+	}
+}
+
 #else
 #error PCI port I/O access is not supported on this architecture yet.
 #endif
@@ -60,11 +60,12 @@ const struct dev_entry ata_via[] = {
 
 static void atavia_chip_writeb(const struct flashctx *flash, uint8_t val, chipaddr addr);
 static uint8_t atavia_chip_readb(const struct flashctx *flash, const chipaddr addr);
+static void atavia_chip_readn(const struct flashctx *flash, uint8_t *buf, const chipaddr addr, size_t len);
 static const struct par_master lpc_master_atavia = {
 		.chip_readb		= atavia_chip_readb,
 		.chip_readw		= fallback_chip_readw,
 		.chip_readl		= fallback_chip_readl,
-		.chip_readn		= fallback_chip_readn,
+		.chip_readn		= atavia_chip_readn,
 		.chip_writeb		= atavia_chip_writeb,
 		.chip_writew		= fallback_chip_writew,
 		.chip_writel		= fallback_chip_writel,
@@ -143,7 +144,7 @@ int atavia_init(void)
 	}
 	free(arg);
 
-	if (rget_io_perms())
+	if (rget_byte_io_perms())
 		return 1;
 
 	dev = pcidev_init(ata_via, PCI_ROM_ADDRESS); /* Acutally no BAR setup needed at all. */
@@ -194,3 +195,31 @@ static uint8_t atavia_chip_readb(const struct flashctx *flash, const chipaddr ad
 	msg_pspew("%s: 0x%02x from 0x%*" PRIxPTR ".\n", __func__, val, PRIxPTR_WIDTH, addr);
 	return val;
 }
+
+static void atavia_chip_readn(const struct flashctx *flash, uint8_t *buf, const chipaddr addr, size_t len)
+{
+	chipaddr pos = addr;
+
+	/* Unaligned head and tail are read bytewise, everything in between with all four bytes enabled. */
+	for (; len && (pos & 3); pos++, buf++, len--)
+		*buf = atavia_chip_readb(flash, pos);
+
+	for (; len >= 4; pos += 4, buf += 4, len -= 4) {
+		pci_write_long(dev, BROM_ADDR, pos);
+		pci_write_byte(dev, BROM_ACCESS, BROM_TRIGGER);
+
+		if (!atavia_ready(dev)) {
+			msg_perr("not ready after read\n");
+		}
+
+		const uint32_t val = pci_read_long(dev, BROM_DATA);
+		buf[0] = val & 0xff;
+		buf[1] = (val >> 8) & 0xff;
+		buf[2] = (val >> 16) & 0xff;
+		buf[3] = (val >> 24) & 0xff;
+		msg_pspew("%s: 0x%08x from 0x%*" PRIxPTR ".\n", __func__, val, PRIxPTR_WIDTH, pos);
+	}
+
+	for (; len; pos++, buf++, len--)
+		*buf = atavia_chip_readb(flash, pos);
+}
@@ -57,8 +57,7 @@ uint8_t sio_read(uint16_t port, uint8_t reg)
 
 void sio_write(uint16_t port, uint8_t reg, uint8_t data)
 {
-	OUTB(reg, port);
-	OUTB(data, port + 1);
+	OUTB_PAIR(reg, data, port);
 }
 
 void sio_mask(uint16_t port, uint8_t reg, uint8_t data, uint8_t mask)
@@ -1460,6 +1459,15 @@ static int intel_piix4_gpo30_lower(void)
 	return intel_piix4_gpo_set(30, 0);
 }
 
+/* Some GPIO registers need word or dword I/O port accesses, which /dev/port can't do. */
+static int board_check_io_wide(void)
+{
+	if (IO_WIDE_OK())
+		return 0;
+	msg_perr("\nERROR: This board enable needs 16/32-bit I/O port access, which is not available.\n");
+	return -1;
+}
+
 /*
  * Set a GPIO line on a given Intel ICH LPC controller.
  */
@@ -1555,6 +1563,9 @@ static int intel_ich_gpio_set(int gpio, int raise)
 		return -1;
 	}
 
+	if (board_check_io_wide())
+		return -1;
+
 	msg_pdbg("\nIntel ICH LPC bridge: %sing GPIO%02d.\n",
 		 raise ? "Rais" : "Dropp", gpio);
 
@@ -1902,6 +1913,8 @@ static int via_apollo_gpo_set(int gpio, int raise)
 		msg_perr("\nERROR: VT82C686 PM device not found.\n");
 		return -1;
 	}
+	if (board_check_io_wide())
+		return -1;
 
 	msg_pdbg("\nVIA Apollo ACPI: %sing GPIO%02d.\n",
 		 raise ? "Rais" : "Dropp", gpio);
@@ -1975,6 +1988,8 @@ static int sis_gpio0_raise_and_w836xx_memw(void)
 		msg_perr("Expected south bridge not found\n");
 		return 1;
 	}
+	if (board_check_io_wide())
+		return 1;
 
 	base = pci_read_word(dev, 0x74);
 	temp = INW(base + 0x68);
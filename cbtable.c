@@ -33,6 +33,15 @@
 
 static char *cb_vendor = NULL, *cb_model = NULL;
 
+/* Reads a dword from the image, which need not be aligned. */
+static unsigned int cb_image_dword(const uint8_t *image, int offset)
+{
+	unsigned int val;
+
+	memcpy(&val, image + offset, sizeof(val));
+	return val;
+}
+
 /* Tries to find coreboot IDs in the supplied image and compares them to the current IDs.
  * Returns...
  * 	-1	if IDs in the image do not match the IDs embedded in the current firmware,
@@ -40,20 +49,26 @@ static char *cb_vendor = NULL, *cb_model = NULL;
  */
 int cb_check_image(const uint8_t *image, int size)
 {
-	const unsigned int *walk;
-	unsigned int mb_part_offset, mb_vendor_offset;
+	int walk;
+	unsigned int image_size, mb_part_offset, mb_vendor_offset;
 	const char *mb_part, *mb_vendor;
 
-	walk = (const unsigned int *)(image + size - 0x10);
-	walk--;
+	/* The alternate location below needs three dwords in front of offset size - 0x80. */
+	if (size < 0x80 + 3 * 4) {
+		msg_pdbg("Flash image is too small to contain coreboot IDs.\n");
+		return 0;
+	}
+
+	walk = size - 0x10 - 4;
+	image_size = cb_image_dword(image, walk);
 
-	if ((*walk) == 0 || ((*walk) & 0x3ff) != 0) {
+	if (image_size == 0 || (image_size & 0x3ff) != 0) {
 		/* Some NVIDIA chipsets store chipset soft straps (IIRC Hypertransport init info etc.) in
 		 * flash at exactly the location where coreboot image size, coreboot vendor name pointer and
 		 * coreboot board name pointer are usually stored. In this case coreboot uses an alternate
 		 * location for the coreboot image data. */
-		walk = (const unsigned int *)(image + size - 0x80);
-		walk--;
+		walk = size - 0x80 - 4;
+		image_size = cb_image_dword(image, walk);
 	}
 
 	/*
@@ -62,10 +77,11 @@ int cb_check_image(const uint8_t *image, int size)
 	 * are outside the image of if the start of ID strings are nonsensical
 	 * (nonprintable and not \0).
 	 */
-	mb_part_offset = *(walk - 1);
-	mb_vendor_offset = *(walk - 2);
-	if ((*walk) == 0 || ((*walk) & 0x3ff) != 0 || (*walk) > size ||
-	    mb_part_offset > size || mb_vendor_offset > size) {
+	mb_part_offset = cb_image_dword(image, walk - 4);
+	mb_vendor_offset = cb_image_dword(image, walk - 8);
+	if (image_size == 0 || (image_size & 0x3ff) != 0 || image_size > size ||
+	    mb_part_offset == 0 || mb_part_offset > size ||
+	    mb_vendor_offset == 0 || mb_vendor_offset > size) {
 		msg_pdbg("Flash image seems to be a legacy BIOS. Disabling coreboot-related checks.\n");
 		return 0;
 	}
@@ -78,8 +94,13 @@ int cb_check_image(const uint8_t *image, int size)
 			 "Disabling coreboot-related checks.\n");
 		return 0;
 	}
+	/* Both IDs are printed and compared as strings, they must end inside the image. */
+	if (!memchr(mb_part, '\0', mb_part_offset) || !memchr(mb_vendor, '\0', mb_vendor_offset)) {
+		msg_pdbg("Flash image has unterminated ID strings. Disabling coreboot-related checks.\n");
+		return 0;
+	}
 
-	msg_pdbg("coreboot last image size (not ROM size) is %d bytes.\n", *walk);
+	msg_pdbg("coreboot last image size (not ROM size) is %d bytes.\n", image_size);
 
 	msg_pdbg("Manufacturer: %s\n", mb_vendor);
 	msg_pdbg("Mainboard ID: %s\n", mb_part);
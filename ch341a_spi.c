@@ -405,6 +405,7 @@ static const struct spi_master spi_master_ch341a_spi = {
 	 * sent to the device and most of their payload streamed via SPI. */
 	.max_data_read	= 4 * 1024,
 	.max_data_write	= 4 * 1024,
+	.write_cmd_cost	= 4096, /* USB round trips for WREN, program and RDSR polling */
 	.command	= ch341a_spi_spi_send_command,
 	.multicommand	= default_spi_send_multicommand,
 	.read		= default_spi_read,
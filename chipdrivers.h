@@ -60,6 +60,9 @@ erasefunc_t *spi_get_erasefn_from_opcode(uint8_t opcode);
 int spi_chip_write_1(struct flashctx *flash, const uint8_t *buf, unsigned int start, unsigned int len);
 int spi_nbyte_read(struct flashctx *flash, unsigned int addr, uint8_t *bytes, unsigned int len);
 int spi_read_chunked(struct flashctx *flash, uint8_t *buf, unsigned int start, unsigned int len, unsigned int chunksize);
+typedef int (*spi_read_consumer_t)(void *data, const uint8_t *buf, unsigned int start, unsigned int len);
+bool spi_can_read_pipelined(const struct flashctx *flash);
+int spi_read_pipelined(struct flashctx *flash, unsigned int start, unsigned int len, spi_read_consumer_t consume, void *data);
 int spi_write_chunked(struct flashctx *flash, const uint8_t *buf, unsigned int start, unsigned int len, unsigned int chunksize);
 int spi_enter_4ba(struct flashctx *flash);
 int spi_exit_4ba(struct flashctx *flash);
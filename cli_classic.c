@@ -43,7 +43,7 @@ static void cli_classic_usage(const char *name)
 	       "-z|"
 #endif
 	       "-p <programmername>[:<parameters>] [-c <chipname>]\n"
-	       "[-E|(-r|-w|-v) <file>] [(-l <layoutfile>|--ifd) [-i <imagename>]...] [-n] [-N] [-f]]\n"
+	       "[-E|--stress|(-r|-w|-v) <file>] [(-l <layoutfile>|--ifd) [-i <imagename>]...] [-n] [-N] [-f]]\n"
 	       "[-V[V[V]]] [-o <logfile>]\n\n", name);
 
 	printf(" -h | --help                        print this help text\n"
@@ -52,6 +52,7 @@ static void cli_classic_usage(const char *name)
 	       " -w | --write <file>                write <file> to flash\n"
 	       " -v | --verify <file>               verify flash against <file>\n"
 	       " -E | --erase                       erase flash memory\n"
+	       "      --stress                      write and read back test patterns (see man page)\n"
 	       " -V | --verbose                     more verbose output\n"
 	       " -c | --chip <chipname>             probe only for specified flash chip\n"
 	       " -f | --force                       force specific operations (see man page)\n"
@@ -62,16 +63,17 @@ static void cli_classic_usage(const char *name)
 	       " -i | --image <name>                only flash image <name> from flash layout\n"
 	       " -o | --output <logfile>            log output to <logfile>\n"
 	       " -L | --list-supported              print supported devices\n"
+	       "      --list-supported-json <file>  write supported devices as JSON to <file>\n"
 #if CONFIG_PRINT_WIKI == 1
 	       " -z | --list-supported-wiki         print supported devices in wiki syntax\n"
 #endif
 	       " -p | --programmer <name>[:<param>] specify the programmer device. One of\n");
 	list_programmers_linebreak(4, 80, 0);
-	printf(".\n\nYou can specify one of -h, -R, -L, "
+	printf(".\n\nYou can specify one of -h, -R, -L, --list-supported-json, "
 #if CONFIG_PRINT_WIKI == 1
 	         "-z, "
 #endif
-	       "-E, -r, -w, -v or no operation.\n"
+	       "-E, --stress, -r, -w, -v or no operation.\n"
 	       "If no operation is specified, flashrom will only probe for flash chips.\n");
 
 	printf("\n\nAdditional features:\n"
@@ -104,17 +106,20 @@ int main(int argc, char *argv[])
 	/* Probe for up to eight flash chips. */
 	struct flashctx flashes[8] = {{0}};
 	struct flashctx *fill_flash;
+	const char *chip_to_probe = NULL;
 	const char *name;
 	int namelen, opt, i, j;
 	int startchip = -1, chipcount = 0, option_index = 0, force = 0, ifd = 0;
 #if CONFIG_PRINT_WIKI == 1
 	int list_supported_wiki = 0;
 #endif
-	int read_it = 0, write_it = 0, erase_it = 0, verify_it = 0;
+	int read_it = 0, write_it = 0, erase_it = 0, verify_it = 0, stress_it = 0;
 	int dont_verify_it = 0, dont_verify_all = 0, list_supported = 0, operation_specified = 0;
+	int list_supported_json = 0;
 	int adp_status = 0, adp_enable = 0, adp_disable = 0;
 	struct flashrom_layout *layout = NULL;
 	enum programmer prog = PROGRAMMER_INVALID;
+	struct flashrom_programmer *flashprog = NULL;
 	int ret = 0;
 
 	static const char optstring[] = "r:Rw:v:nNVEfc:l:i:p:Lzho:";
@@ -133,6 +138,8 @@ int main(int argc, char *argv[])
 		{"image",		1, NULL, 'i'},
 		{"list-supported",	0, NULL, 'L'},
 		{"list-supported-wiki",	0, NULL, 'z'},
+		{"list-supported-json",	1, NULL, 0x0104},
+		{"stress",		0, NULL, 0x0105},
 		{"programmer",		1, NULL, 'p'},
 		{"help",		0, NULL, 'h'},
 		{"version",		0, NULL, 'R'},
@@ -224,6 +231,14 @@ int main(int argc, char *argv[])
 			}
 			erase_it = 1;
 			break;
+		case 0x0105:
+			if (++operation_specified > 1) {
+				fprintf(stderr, "More than one operation "
+					"specified. Aborting.\n");
+				cli_classic_abort_usage();
+			}
+			stress_it = 1;
+			break;
 		case 'f':
 			force = 1;
 			break;
@@ -261,6 +276,15 @@ int main(int argc, char *argv[])
 			}
 			list_supported = 1;
 			break;
+		case 0x0104:
+			if (++operation_specified > 1) {
+				fprintf(stderr, "More than one operation "
+					"specified. Aborting.\n");
+				cli_classic_abort_usage();
+			}
+			list_supported_json = 1;
+			filename = strdup(optarg);
+			break;
 		case 'z':
 #if CONFIG_PRINT_WIKI == 1
 			if (++operation_specified > 1) {
@@ -395,6 +419,12 @@ int main(int argc, char *argv[])
 		goto out;
 	}
 
+	if (list_supported_json) {
+		if (check_filename(filename, "output") || print_supported_json(filename))
+			ret = 1;
+		goto out;
+	}
+
 #ifndef STANDALONE
 	start_logging();
 #endif /* !STANDALONE */
@@ -452,19 +482,22 @@ int main(int argc, char *argv[])
 	/* FIXME: Delay calibration should happen in programmer code. */
 	myusec_calibrate_delay();
 
-	if (programmer_init(prog, pparam)) {
+	if (programmer_init(&flashprog, prog, pparam)) {
 		msg_perr("Error: Programmer initialization failed.\n");
 		ret = 1;
 		goto out_shutdown;
 	}
-	tempstr = flashbuses_to_text(get_buses_supported());
+	tempstr = flashbuses_to_text(get_buses_supported(flashprog));
 	msg_pdbg("The following protocols are supported: %s.\n", tempstr);
 	free(tempstr);
 
-	for (j = 0; j < registered_master_count; j++) {
+	for (i = 0; i < ARRAY_SIZE(flashes); i++)
+		flashes[i].chip_to_probe = chip_to_probe;
+
+	for (j = 0; j < flashprog->master_count; j++) {
 		startchip = 0;
 		while (chipcount < ARRAY_SIZE(flashes)) {
-			startchip = probe_flash(&registered_masters[j], startchip, &flashes[chipcount], 0);
+			startchip = probe_flash(&flashprog->masters[j], startchip, &flashes[chipcount], 0);
 			if (startchip == -1)
 				break;
 			chipcount++;
@@ -487,12 +520,12 @@ int main(int argc, char *argv[])
 				  "automatically.\n");
 		}
 		if (force && read_it && chip_to_probe) {
-			struct registered_master *mst;
+			const struct registered_master *mst;
 			int compatible_masters = 0;
 			msg_cinfo("Force read (-f -r -c) requested, pretending the chip is there:\n");
 			/* This loop just counts compatible controllers. */
-			for (j = 0; j < registered_master_count; j++) {
-				mst = &registered_masters[j];
+			for (j = 0; j < flashprog->master_count; j++) {
+				mst = &flashprog->masters[j];
 				/* chip is still set from the chip_to_probe earlier in this function. */
 				if (mst->buses_supported & chip->bustype)
 					compatible_masters++;
@@ -505,8 +538,8 @@ int main(int argc, char *argv[])
 			if (compatible_masters > 1)
 				msg_cinfo("More than one compatible controller found for the requested flash "
 					  "chip, using the first one.\n");
-			for (j = 0; j < registered_master_count; j++) {
-				mst = &registered_masters[j];
+			for (j = 0; j < flashprog->master_count; j++) {
+				mst = &flashprog->masters[j];
 				startchip = probe_flash(mst, 0, &flashes[0], 1);
 				if (startchip != -1)
 					break;
@@ -558,7 +591,7 @@ int main(int argc, char *argv[])
 		goto out_shutdown;
 	}
 
-	if (!(read_it | write_it | verify_it | erase_it | adp_status | adp_enable | adp_disable)) {
+	if (!(read_it | write_it | verify_it | erase_it | stress_it | adp_status | adp_enable | adp_disable)) {
 		msg_ginfo("No operations were specified.\n");
 		goto out_shutdown;
 	}
@@ -592,6 +625,8 @@ int main(int argc, char *argv[])
 		ret = do_write(fill_flash, filename);
 	} else if (verify_it) {
 		ret = do_verify(fill_flash, filename);
+	} else if (stress_it) {
+		ret = do_stress(fill_flash);
 	} else if (adp_status) {
 		ret = w25q_get_adp_status(fill_flash);
 	} else if (adp_enable) {
@@ -604,7 +639,7 @@ int main(int argc, char *argv[])
 	flashrom_layout_release(layout);
 
 out_shutdown:
-	programmer_shutdown();
+	programmer_shutdown(flashprog);
 out:
 	for (i = 0; i < chipcount; i++)
 		free(flashes[i].chip);
@@ -613,9 +648,7 @@ out:
 	free(filename);
 	free(layoutfile);
 	free(pparam);
-	/* clean up global variables */
 	free((char *)chip_to_probe); /* Silence! Freeing is not modifying contents. */
-	chip_to_probe = NULL;
 #ifndef STANDALONE
 	free(logfile);
 	ret |= close_logfile();
@@ -387,6 +387,12 @@ static int dediprog_set_spi_speed(unsigned int spispeed_idx)
 	return 0;
 }
 
+/* Maps the ascending speed index of spi_autotune_speed() to the descending spispeeds table. */
+static int dediprog_autotune_set_speed(unsigned int idx)
+{
+	return dediprog_set_spi_speed(ARRAY_SIZE(spispeeds) - 2 - idx);
+}
+
 static void fill_rw_cmd_payload(uint8_t *data_packet, unsigned int count, uint8_t dedi_spi_cmd, unsigned int *value, unsigned int *idx, unsigned int start) {
 	/* First 5 bytes are common in both generations. */
 	data_packet[0] = count & 0xff;
@@ -943,13 +949,17 @@ int dediprog_init(void)
 {
 	char *voltage, *device, *spispeed, *target_str;
 	int spispeed_idx = 1;
+	bool autotune = false;
 	int millivolt = 3500;
 	long usedevice = 0;
 	long target = FLASH_TYPE_APPLICATION_FLASH_1;
 	int i, ret;
 
 	spispeed = extract_programmer_param("spispeed");
-	if (spispeed) {
+	if (spispeed && !strcasecmp(spispeed, "auto")) {
+		autotune = true;
+		free(spispeed);
+	} else if (spispeed) {
 		for (i = 0; spispeeds[i].name; ++i) {
 			if (!strcasecmp(spispeeds[i].name, spispeed)) {
 				spispeed_idx = i;
@@ -1097,6 +1107,20 @@ int dediprog_init(void)
 	if (dediprog_standalone_mode())
 		return 1;
 
+	if (autotune && dediprog_firmwareversion < FIRMWARE_VERSION(5, 0, 0)) {
+		msg_pwarn("Firmware is too old to set the SPI speed, not autotuning.\n");
+	} else if (autotune) {
+		const int idx = spi_autotune_speed(&spi_master_dediprog, ARRAY_SIZE(spispeeds) - 1,
+						   dediprog_autotune_set_speed);
+		if (idx < 0) {
+			dediprog_set_leds(LED_ERROR);
+			return 1;
+		}
+		msg_pinfo("Using %sHz SPI clock, use spispeed=%s to skip autotuning next time.\n",
+			  spispeeds[ARRAY_SIZE(spispeeds) - 2 - idx].name,
+			  spispeeds[ARRAY_SIZE(spispeeds) - 2 - idx].name);
+	}
+
 	if (register_spi_master(&spi_master_dediprog) || dediprog_set_leds(LED_NONE))
 		return 1;
 
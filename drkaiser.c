@@ -45,11 +45,13 @@ static void drkaiser_chip_writeb(const struct flashctx *flash, uint8_t val,
 				 chipaddr addr);
 static uint8_t drkaiser_chip_readb(const struct flashctx *flash,
 				   const chipaddr addr);
+static void drkaiser_chip_readn(const struct flashctx *flash, uint8_t *buf,
+				const chipaddr addr, size_t len);
 static const struct par_master par_master_drkaiser = {
 		.chip_readb		= drkaiser_chip_readb,
 		.chip_readw		= fallback_chip_readw,
 		.chip_readl		= fallback_chip_readl,
-		.chip_readn		= fallback_chip_readn,
+		.chip_readn		= drkaiser_chip_readn,
 		.chip_writeb		= drkaiser_chip_writeb,
 		.chip_writew		= fallback_chip_writew,
 		.chip_writel		= fallback_chip_writel,
@@ -61,7 +63,7 @@ int drkaiser_init(void)
 	struct pci_dev *dev = NULL;
 	uint32_t addr;
 
-	if (rget_io_perms())
+	if (rget_byte_io_perms())
 		return 1;
 
 	dev = pcidev_init(drkaiser_pcidev, PCI_BASE_ADDRESS_2);
@@ -97,3 +99,18 @@ static uint8_t drkaiser_chip_readb(const struct flashctx *flash,
 {
 	return pci_mmio_readb(drkaiser_bar + (addr & DRKAISER_MEMMAP_MASK));
 }
+
+static void drkaiser_chip_readn(const struct flashctx *flash, uint8_t *buf,
+				const chipaddr addr, size_t len)
+{
+	chipaddr pos = addr;
+
+	/* Copy straight from the window, splitting only where the address wraps around. */
+	while (len) {
+		const size_t chunk = min(len, DRKAISER_MEMMAP_MASK + 1 - (pos & DRKAISER_MEMMAP_MASK));
+		mmio_readn(drkaiser_bar + (pos & DRKAISER_MEMMAP_MASK), buf, chunk);
+		pos += chunk;
+		buf += chunk;
+		len -= chunk;
+	}
+}
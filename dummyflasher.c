@@ -96,6 +96,16 @@ static const uint8_t sfdp_table[] = {
 
 static unsigned int spi_write_256_chunksize = 256;
 
+/* SPI bus operation counters, printed at shutdown to compare the cost of core changes. */
+static struct {
+	unsigned long commands;
+	unsigned long bytes;
+	unsigned long reads;
+	unsigned long erases;
+	unsigned long programs;
+	unsigned long polls;
+} dummy_stats;
+
 static int dummy_spi_send_command(struct flashctx *flash, unsigned int writecnt, unsigned int readcnt,
 				  const unsigned char *writearr, unsigned char *readarr);
 static int dummy_spi_write_256(struct flashctx *flash, const uint8_t *buf,
@@ -137,6 +147,9 @@ enum chipbustype dummy_buses_supported = BUS_NONE;
 static int dummy_shutdown(void *data)
 {
 	msg_pspew("%s\n", __func__);
+	msg_pdbg("Dummy SPI statistics: %lu commands, %lu bytes, %lu reads, %lu erases, %lu programs, "
+		 "%lu status polls\n", dummy_stats.commands, dummy_stats.bytes, dummy_stats.reads,
+		 dummy_stats.erases, dummy_stats.programs, dummy_stats.polls);
 #if EMULATE_CHIP
 	if (emu_chip != EMULATE_NONE) {
 		if (emu_persistent_image) {
@@ -165,6 +178,7 @@ int dummy_init(void)
 
 	msg_pspew("%s\n", __func__);
 
+	memset(&dummy_stats, 0, sizeof(dummy_stats));
 	bustext = extract_programmer_param("bus");
 	msg_pdbg("Requested buses are: %s\n", bustext ? bustext : "default");
 	if (!bustext)
@@ -602,6 +616,11 @@ static int emulate_spi_chip_response(unsigned int writecnt,
 		emu_status = writearr[1] & ~SPI_SR_WIP;
 		msg_pdbg2("WRSR wrote 0x%02x.\n", emu_status);
 		break;
+	case MX_RDSCUR:
+		/* Program and erase never fail here. */
+		if (emu_chip == EMULATE_MACRONIX_MX25L6436)
+			memset(readarr, 0, readcnt);
+		break;
 	case JEDEC_READ:
 		offs = writearr[1] << 16 | writearr[2] << 8 | writearr[3];
 		/* Truncate to emu_chip_size. */
@@ -802,6 +821,30 @@ static int dummy_spi_send_command(struct flashctx *flash, unsigned int writecnt,
 	for (i = 0; i < writecnt; i++)
 		msg_pspew(" 0x%02x", writearr[i]);
 
+	dummy_stats.commands++;
+	dummy_stats.bytes += writecnt + readcnt;
+	if (writecnt) {
+		switch (writearr[0]) {
+		case JEDEC_READ:
+			dummy_stats.reads++;
+			break;
+		case JEDEC_SE:
+		case JEDEC_BE_52:
+		case JEDEC_BE_D8:
+		case JEDEC_CE_60:
+		case JEDEC_CE_C7:
+			dummy_stats.erases++;
+			break;
+		case JEDEC_BYTE_PROGRAM:
+		case JEDEC_AAI_WORD_PROGRAM:
+			dummy_stats.programs++;
+			break;
+		case JEDEC_RDSR:
+			dummy_stats.polls++;
+			break;
+		}
+	}
+
 	/* Response for unknown commands and missing chip is 0xff. */
 	memset(readarr, 0xff, readcnt);
 #if EMULATE_SPI_CHIP
@@ -52,6 +52,16 @@ typedef uintptr_t chipaddr;
 #define PRIxPTR_WIDTH ((int)(sizeof(uintptr_t)*2))
 
 int register_shutdown(int (*function) (void *data), void *data);
+/* A register value saved before a reversible write, see register_undo(). */
+struct undo_entry {
+	int (*restore)(const struct undo_entry *entry);
+	uint64_t addr;		/* Register location, meaning depends on restore. */
+	unsigned int type;	/* Access width or similar, also part of the key. */
+	uint32_t val;		/* Original value. */
+	void *priv;
+};
+struct undo_entry *register_undo(int (*restore)(const struct undo_entry *entry), uint64_t addr,
+				 unsigned int type);
 int shutdown_free(void *data);
 void *programmer_map_flash_region(const char *descr, uintptr_t phys_addr, size_t len);
 void programmer_unmap_flash_region(void *virt_addr, size_t len);
@@ -126,6 +136,11 @@ enum write_granularity {
 #define FEATURE_4BA_READ	(1 << 13) /**< Native 4BA read instruction (0x13) is supported. */
 #define FEATURE_4BA_FAST_READ	(1 << 14) /**< Native 4BA fast read instruction (0x0c) is supported. */
 #define FEATURE_4BA_WRITE	(1 << 15) /**< Native 4BA byte program (0x12) is supported. */
+/* Program/erase failures are reliably reported by the chip, so a read-back after each erase is redundant. */
+#define FEATURE_ERR_SCUR	(1 << 16) /**< Macronix security register (0x2b) P_FAIL/E_FAIL bits */
+#define FEATURE_ERR_FSR		(1 << 17) /**< Micron flag status register (0x70) error bits */
+#define FEATURE_ERR_SR		(1 << 18) /**< Intel-style status register (SR.5/SR.4/SR.3/SR.1) */
+#define FEATURE_ERR_STATUS	(FEATURE_ERR_SCUR | FEATURE_ERR_FSR | FEATURE_ERR_SR)
 /* 4BA Shorthands */
 #define FEATURE_4BA_NATIVE	(FEATURE_4BA_READ | FEATURE_4BA_FAST_READ | FEATURE_4BA_WRITE)
 #define FEATURE_4BA		(FEATURE_4BA_ENTER | FEATURE_4BA_EXT_ADDR | FEATURE_4BA_NATIVE)
@@ -229,7 +244,9 @@ struct flashrom_flashctx {
 	/* Some flash devices have an additional register space; semantics are like above. */
 	uintptr_t physical_registers;
 	chipaddr virtual_registers;
-	struct registered_master *mst;
+	const struct registered_master *mst;
+	/* Name of the chip requested by the user, NULL to probe for any. */
+	const char *chip_to_probe;
 	const struct flashrom_layout *layout;
 	struct single_layout fallback_layout;
 	struct {
@@ -244,6 +261,14 @@ struct flashrom_flashctx {
            of the extended address register. */
 	int address_high_byte;
 	bool in_4ba_mode;
+	/* Set by SPI masters whose last command already waited for the chip to become ready. */
+	bool spi_wip_clear;
+	/* Set once the chip's program/erase error flags were actually read. */
+	bool error_status_checked;
+	/* The master can't issue the command to read the error flags (e.g. locked ICH opcodes). */
+	bool error_status_unavailable;
+	/* The current operation only reads, nothing is written or verified based on the data. */
+	bool read_only_access;
 };
 
 /* Timing used in probe routines. ZERO is -2 to differentiate between an unset
@@ -270,6 +295,7 @@ void chip_readn(const struct flashctx *flash, uint8_t *buf, const chipaddr addr,
 
 /* print.c */
 int print_supported(void);
+int print_supported_json(const char *filename);
 void print_supported_wiki(void);
 
 /* helpers.c */
@@ -288,13 +314,12 @@ size_t strnlen(const char *str, size_t n);
 
 /* flashrom.c */
 extern const char flashrom_version[];
-extern const char *chip_to_probe;
 char *flashbuses_to_text(enum chipbustype bustype);
 int map_flash(struct flashctx *flash);
 void unmap_flash(struct flashctx *flash);
 int read_memmapped(struct flashctx *flash, uint8_t *buf, unsigned int start, unsigned int len);
 int erase_flash(struct flashctx *flash);
-int probe_flash(struct registered_master *mst, int startchip, struct flashctx *fill_flash, int force);
+int probe_flash(const struct registered_master *mst, int startchip, struct flashctx *fill_flash, int force);
 int read_flash_to_file(struct flashctx *flash, const char *filename);
 char *extract_param(const char *const *haystack, const char *needle, const char *delim);
 int verify_range(struct flashctx *flash, const uint8_t *cmpbuf, unsigned int start, unsigned int len);
@@ -312,6 +337,7 @@ int do_read(struct flashctx *, const char *filename);
 int do_erase(struct flashctx *);
 int do_write(struct flashctx *, const char *const filename);
 int do_verify(struct flashctx *, const char *const filename);
+int do_stress(struct flashctx *);
 
 /* Something happened that shouldn't happen, but we can go on. */
 #define ERROR_NONFATAL 0x100
@@ -381,5 +407,5 @@ struct spi_command {
 int spi_send_command(struct flashctx *flash, unsigned int writecnt, unsigned int readcnt, const unsigned char *writearr, unsigned char *readarr);
 int spi_send_multicommand(struct flashctx *flash, struct spi_command *cmds);
 
-enum chipbustype get_buses_supported(void);
+enum chipbustype get_buses_supported(const struct flashrom_programmer *flashprog);
 #endif				/* !__FLASH_H__ */
@@ -29,6 +29,7 @@
 #ifndef __LIBPAYLOAD__
 #include <fcntl.h>
 #include <sys/stat.h>
+#include <sys/time.h>
 #endif
 #include <string.h>
 #include <unistd.h>
@@ -46,10 +47,8 @@
 #include "chipdrivers.h"
 
 const char flashrom_version[] = FLASHROM_VERSION;
-const char *chip_to_probe = NULL;
 
 static enum programmer programmer = PROGRAMMER_INVALID;
-static const char *programmer_param = NULL;
 
 /*
  * Programmers supporting multiple buses can have differing size limits on
@@ -218,7 +217,7 @@ const struct programmer_entry programmer_table[] = {
 		.init			= ft2232_spi_init,
 		.map_flash_region	= fallback_map,
 		.unmap_flash_region	= fallback_unmap,
-		.delay			= internal_delay,
+		.delay			= ft2232_spi_delay,
 	},
 #endif
 
@@ -358,6 +357,18 @@ const struct programmer_entry programmer_table[] = {
 	},
 #endif
 
+#if CONFIG_LINUX_MTD == 1
+	{
+		.name			= "linux_mtd",
+		.type			= OTHER,
+		.devs.note		= "Device files /dev/mtd*\n",
+		.init			= linux_mtd_init,
+		.map_flash_region	= fallback_map,
+		.unmap_flash_region	= fallback_unmap,
+		.delay			= internal_delay,
+	},
+#endif
+
 #if CONFIG_USBBLASTER_SPI == 1
 	{
 		.name			= "usbblaster_spi",
@@ -390,7 +401,7 @@ const struct programmer_entry programmer_table[] = {
 		.init			= pickit2_spi_init,
 		.map_flash_region	= fallback_map,
 		.unmap_flash_region	= fallback_unmap,
-		.delay			= internal_delay,
+		.delay			= pickit2_spi_delay,
 	},
 #endif
 
@@ -409,20 +420,25 @@ const struct programmer_entry programmer_table[] = {
 	{0}, /* This entry corresponds to PROGRAMMER_INVALID. */
 };
 
-#define SHUTDOWN_MAXFN 32
-static int shutdown_fn_count = 0;
+static size_t shutdown_fn_count = 0;
+static size_t shutdown_fn_size = 0;
 /** @private */
 struct shutdown_func_data {
 	int (*func) (void *data);
 	void *data;
-} static shutdown_fn[SHUTDOWN_MAXFN];
+} static *shutdown_fn = NULL;
+/* Saved register values, restored in reverse order by undo_log_replay(). */
+static struct undo_entry *undo_log = NULL;
+static size_t undo_log_count = 0;
+static size_t undo_log_size = 0;
 /* Initialize to 0 to make sure nobody registers a shutdown function before
  * programmer init.
  */
 static int may_register_shutdown = 0;
 
-/* Did we change something or was every erase/write skipped (if any)? */
-static bool all_skipped = true;
+/* The programmer between programmer_init() and programmer_shutdown(). Drivers
+ * extract their parameters and register their masters here during init. */
+static struct flashrom_programmer *active_programmer = NULL;
 
 static int check_block_eraser(const struct flashctx *flash, int k, int log);
 
@@ -442,16 +458,21 @@ int shutdown_free(void *data)
  */
 int register_shutdown(int (*function) (void *data), void *data)
 {
-	if (shutdown_fn_count >= SHUTDOWN_MAXFN) {
-		msg_perr("Tried to register more than %i shutdown functions.\n",
-			 SHUTDOWN_MAXFN);
-		return 1;
-	}
 	if (!may_register_shutdown) {
 		msg_perr("Tried to register a shutdown function before "
 			 "programmer init.\n");
 		return 1;
 	}
+	if (shutdown_fn_count == shutdown_fn_size) {
+		const size_t size = shutdown_fn_size ? shutdown_fn_size * 2 : 16;
+		struct shutdown_func_data *const fns = realloc(shutdown_fn, size * sizeof(*fns));
+		if (!fns) {
+			msg_perr("Out of memory while registering a shutdown function.\n");
+			return 1;
+		}
+		shutdown_fn = fns;
+		shutdown_fn_size = size;
+	}
 	shutdown_fn[shutdown_fn_count].func = function;
 	shutdown_fn[shutdown_fn_count].data = data;
 	shutdown_fn_count++;
@@ -459,14 +480,85 @@ int register_shutdown(int (*function) (void *data), void *data)
 	return 0;
 }
 
-int programmer_init(enum programmer prog, const char *param)
+/* Restores all undo log entries recorded since the one at index data. */
+static int undo_log_replay(void *data)
+{
+	const size_t first = (uintptr_t)data;
+	int ret = 0;
+
+	while (undo_log_count > first) {
+		const struct undo_entry *const entry = &undo_log[--undo_log_count];
+		ret |= entry->restore(entry);
+	}
+	if (!undo_log_count) {
+		free(undo_log);
+		undo_log = NULL;
+		undo_log_size = 0;
+	}
+	return ret;
+}
+
+/* Record that the register identified by (restore, addr, type) is about to be
+ * written. Returns the new entry, where the caller stores the original value,
+ * or NULL if that value is already saved (or no programmer is initialized).
+ * Consecutive entries share a single shutdown function, so they are restored
+ * in reverse order at the place in the shutdown sequence where they were
+ * recorded.
+ */
+struct undo_entry *register_undo(int (*restore)(const struct undo_entry *entry), uint64_t addr,
+				 unsigned int type)
+{
+	struct undo_entry *entry;
+	size_t i;
+
+	/* Only the first saved value matters, it is restored last. */
+	for (i = undo_log_count; i > 0; i--) {
+		entry = &undo_log[i - 1];
+		if (entry->restore == restore && entry->addr == addr && entry->type == type)
+			return NULL;
+	}
+	if (undo_log_count == undo_log_size) {
+		const size_t size = undo_log_size ? undo_log_size * 2 : 32;
+		struct undo_entry *const entries = realloc(undo_log, size * sizeof(*entries));
+		if (!entries) {
+			msg_gerr("Out of memory!\n");
+			exit(1);
+		}
+		undo_log = entries;
+		undo_log_size = size;
+	}
+	if (!shutdown_fn_count || shutdown_fn[shutdown_fn_count - 1].func != undo_log_replay) {
+		if (register_shutdown(undo_log_replay, (void *)(uintptr_t)undo_log_count))
+			return NULL;
+	}
+	entry = &undo_log[undo_log_count++];
+	*entry = (struct undo_entry) {
+		.restore	= restore,
+		.addr		= addr,
+		.type		= type,
+	};
+	return entry;
+}
+
+int programmer_init(struct flashrom_programmer **const flashprog, enum programmer prog, const char *param)
 {
 	int ret;
 
+	*flashprog = NULL;
 	if (prog >= PROGRAMMER_INVALID) {
 		msg_perr("Invalid programmer specified!\n");
 		return -1;
 	}
+	/* Programmer drivers keep their state in static variables, only one can be active at a time. */
+	if (active_programmer) {
+		msg_perr("Another programmer is still initialized, shut it down first!\n");
+		return -1;
+	}
+	active_programmer = calloc(1, sizeof(*active_programmer));
+	if (!active_programmer) {
+		msg_perr("Out of memory!\n");
+		return 1;
+	}
 	programmer = prog;
 	/* Initialize all programmer specific data. */
 	/* Default to unlimited decode sizes. */
@@ -483,25 +575,32 @@ int programmer_init(enum programmer prog, const char *param)
 	/* Default to allowing writes. Broken programmers set this to 0. */
 	programmer_may_write = 1;
 
-	programmer_param = param;
+	active_programmer->param = param;
 	msg_pdbg("Initializing %s programmer\n", programmer_table[programmer].name);
 	ret = programmer_table[programmer].init();
-	if (programmer_param && strlen(programmer_param)) {
+	param = active_programmer->param;
+	if (param && strlen(param)) {
 		if (ret != 0) {
 			/* It is quite possible that any unhandled programmer parameter would have been valid,
 			 * but an error in actual programmer init happened before the parameter was evaluated.
 			 */
 			msg_pwarn("Unhandled programmer parameters (possibly due to another failure): %s\n",
-				  programmer_param);
+				  param);
 		} else {
 			/* Actual programmer init was successful, but the user specified an invalid or unusable
 			 * (for the current programmer configuration) parameter.
 			 */
-			msg_perr("Unhandled programmer parameters: %s\n", programmer_param);
+			msg_perr("Unhandled programmer parameters: %s\n", param);
 			msg_perr("Aborting.\n");
 			ret = ERROR_FATAL;
 		}
 	}
+	if (ret) {
+		free(active_programmer);
+		active_programmer = NULL;
+	} else {
+		*flashprog = active_programmer;
+	}
 	return ret;
 }
 
@@ -510,19 +609,22 @@ int programmer_init(enum programmer prog, const char *param)
  * require a call to programmer_init() (afterwards).
  *
  * @return The OR-ed result values of all shutdown functions (i.e. 0 on success). */
-int programmer_shutdown(void)
+int programmer_shutdown(struct flashrom_programmer *const flashprog)
 {
 	int ret = 0;
 
 	/* Registering shutdown functions is no longer allowed. */
 	may_register_shutdown = 0;
 	while (shutdown_fn_count > 0) {
-		int i = --shutdown_fn_count;
+		size_t i = --shutdown_fn_count;
 		ret |= shutdown_fn[i].func(shutdown_fn[i].data);
 	}
+	free(shutdown_fn);
+	shutdown_fn = NULL;
+	shutdown_fn_size = 0;
 
-	programmer_param = NULL;
-	registered_master_count = 0;
+	free(flashprog);
+	active_programmer = NULL;
 
 	return ret;
 }
@@ -660,7 +762,38 @@ char *extract_param(const char *const *haystack, const char *needle, const char
 
 char *extract_programmer_param(const char *param_name)
 {
-	return extract_param(&programmer_param, param_name, ",");
+	if (!active_programmer)
+		return NULL;
+	return extract_param(&active_programmer->param, param_name, ",");
+}
+
+/* This function copies the struct registered_master parameter. */
+int register_master(const struct registered_master *mst)
+{
+	if (!active_programmer) {
+		msg_perr("Tried to register a master before programmer init.\n");
+		return ERROR_FLASHROM_BUG;
+	}
+	if (active_programmer->master_count >= MASTERS_MAX) {
+		msg_perr("Tried to register more than %i master "
+			 "interfaces.\n", MASTERS_MAX);
+		return ERROR_FLASHROM_LIMIT;
+	}
+	active_programmer->masters[active_programmer->master_count] = *mst;
+	active_programmer->master_count++;
+
+	return 0;
+}
+
+enum chipbustype get_buses_supported(const struct flashrom_programmer *const flashprog)
+{
+	int i;
+	enum chipbustype ret = BUS_NONE;
+
+	for (i = 0; i < flashprog->master_count; i++)
+		ret |= flashprog->masters[i].buses_supported;
+
+	return ret;
 }
 
 /* Returns the number of well-defined erasers for a chip. */
@@ -1029,7 +1162,7 @@ int generate_testpattern(uint8_t *buf, uint32_t size, int variant)
 			buf[i] = ~(i & 0xff);
 		break;
 	case 10:
-		for (i = 0; i < size % 2; i++) {
+		for (i = 0; i < size / 2; i++) {
 			buf[i * 2] = (i >> 8) & 0xff;
 			buf[i * 2 + 1] = i & 0xff;
 		}
@@ -1037,7 +1170,7 @@ int generate_testpattern(uint8_t *buf, uint32_t size, int variant)
 			buf[i * 2] = (i >> 8) & 0xff;
 		break;
 	case 11:
-		for (i = 0; i < size % 2; i++) {
+		for (i = 0; i < size / 2; i++) {
 			buf[i * 2] = ~((i >> 8) & 0xff);
 			buf[i * 2 + 1] = ~(i & 0xff);
 		}
@@ -1198,14 +1331,14 @@ char *flashbuses_to_text(enum chipbustype bustype)
 	return ret;
 }
 
-int probe_flash(struct registered_master *mst, int startchip, struct flashctx *flash, int force)
+int probe_flash(const struct registered_master *mst, int startchip, struct flashctx *flash, int force)
 {
 	const struct flashchip *chip;
 	enum chipbustype buses_common;
 	char *tmp;
 
 	for (chip = flashchips + startchip; chip && chip->name; chip++) {
-		if (chip_to_probe && strcmp(chip->name, chip_to_probe) != 0)
+		if (flash->chip_to_probe && strcmp(chip->name, flash->chip_to_probe) != 0)
 			continue;
 		buses_common = mst->buses_supported & chip->bustype;
 		if (!buses_common)
@@ -1357,6 +1490,32 @@ out:
 #endif
 }
 
+#ifndef __LIBPAYLOAD__
+/* Flushes the file and fsync()s it if it is a regular file. */
+static int sync_image_file(FILE *image, const char *filename)
+{
+	if (fflush(image)) {
+		msg_gerr("Error: flushing file \"%s\" failed: %s\n", filename, strerror(errno));
+		return 1;
+	}
+	// Try to fsync() only regular files and if that function is available at all (e.g. not on MinGW).
+#if defined(_POSIX_FSYNC) && (_POSIX_FSYNC != -1)
+	struct stat image_stat;
+	if (fstat(fileno(image), &image_stat) != 0) {
+		msg_gerr("Error: getting metadata of file \"%s\" failed: %s\n", filename, strerror(errno));
+		return 1;
+	}
+	if (S_ISREG(image_stat.st_mode)) {
+		if (fsync(fileno(image))) {
+			msg_gerr("Error: fsyncing file \"%s\" failed: %s\n", filename, strerror(errno));
+			return 1;
+		}
+	}
+#endif
+	return 0;
+}
+#endif
+
 int write_buf_to_file(const unsigned char *buf, unsigned long size, const char *filename)
 {
 #ifdef __LIBPAYLOAD__
@@ -1381,42 +1540,121 @@ int write_buf_to_file(const unsigned char *buf, unsigned long size, const char *
 		ret = 1;
 		goto out;
 	}
-	if (fflush(image)) {
-		msg_gerr("Error: flushing file \"%s\" failed: %s\n", filename, strerror(errno));
+	if (sync_image_file(image, filename))
+		ret = 1;
+out:
+	if (fclose(image)) {
+		msg_gerr("Error: closing file \"%s\" failed: %s\n", filename, strerror(errno));
 		ret = 1;
 	}
-	// Try to fsync() only regular files and if that function is available at all (e.g. not on MinGW).
-#if defined(_POSIX_FSYNC) && (_POSIX_FSYNC != -1)
+	return ret;
+#endif
+}
+
+/* The streamed dump is renamed over the file in the end, which Windows can't do for existing files. */
+#if !defined(__LIBPAYLOAD__) && !IS_WINDOWS
+static int write_chunk_to_file(void *const image, const uint8_t *const buf,
+			       const unsigned int start, const unsigned int len)
+{
+	if (fwrite(buf, 1, len, image) != len) {
+		msg_gerr("Error: writing 0x%x bytes at 0x%06x to file failed.\n", len, start);
+		return 1;
+	}
+	return 0;
+}
+
+/* The streamed dump goes to a temporary file first, that only works for regular files. */
+static bool can_stream_to_file(const char *filename)
+{
 	struct stat image_stat;
-	if (fstat(fileno(image), &image_stat) != 0) {
-		msg_gerr("Error: getting metadata of file \"%s\" failed: %s\n", filename, strerror(errno));
-		ret = 1;
-		goto out;
+	if (stat(filename, &image_stat))
+		return errno == ENOENT;
+	return S_ISREG(image_stat.st_mode);
+}
+
+/*
+ * Stream the whole chip to a file while further reads are in flight.
+ * Only the programmer's read window is buffered instead of the whole chip.
+ * A failed read leaves an existing file untouched, like the buffered path.
+ */
+static int read_flash_to_file_pipelined(struct flashctx *flash, const char *filename)
+{
+	const unsigned long size = flash->chip->total_size * 1024;
+	struct stat image_stat;
+	FILE *image;
+	mode_t mode;
+	int fd, ret;
+
+	char *const tmpname = malloc(strlen(filename) + sizeof(".XXXXXX"));
+	if (!tmpname) {
+		msg_gerr("Out of memory!\n");
+		return 1;
 	}
-	if (S_ISREG(image_stat.st_mode)) {
-		if (fsync(fileno(image))) {
-			msg_gerr("Error: fsyncing file \"%s\" failed: %s\n", filename, strerror(errno));
-			ret = 1;
-		}
+	sprintf(tmpname, "%s.XXXXXX", filename);
+
+	/* Give the dump the permissions fopen() would have, mkstemp() uses 0600. */
+	if (!stat(filename, &image_stat)) {
+		mode = image_stat.st_mode & 07777;
+	} else {
+		mode = umask(0);
+		umask(mode);
+		mode = 0666 & ~mode;
 	}
-#endif
-out:
+
+	fd = mkstemp(tmpname);
+	if (fd < 0) {
+		msg_gerr("Error: creating a temporary file for \"%s\" failed: %s\n", filename, strerror(errno));
+		free(tmpname);
+		return 1;
+	}
+	if (fchmod(fd, mode) || (image = fdopen(fd, "wb")) == NULL) {
+		msg_gerr("Error: opening file \"%s\" failed: %s\n", tmpname, strerror(errno));
+		close(fd);
+		ret = 1;
+		goto out_unlink;
+	}
+
+	ret = spi_read_pipelined(flash, 0, size, write_chunk_to_file, image);
+	if (ret)
+		msg_cerr("Read operation failed!\n");
+	if (!ret && sync_image_file(image, tmpname))
+		ret = 1;
 	if (fclose(image)) {
-		msg_gerr("Error: closing file \"%s\" failed: %s\n", filename, strerror(errno));
+		msg_gerr("Error: closing file \"%s\" failed: %s\n", tmpname, strerror(errno));
 		ret = 1;
 	}
+	if (!ret && rename(tmpname, filename)) {
+		msg_gerr("Error: renaming \"%s\" to \"%s\" failed: %s\n", tmpname, filename, strerror(errno));
+		ret = 1;
+	}
+
+out_unlink:
+	if (ret)
+		unlink(tmpname);
+	free(tmpname);
 	return ret;
-#endif
 }
+#endif
 
 static int read_by_layout(struct flashctx *, uint8_t *);
 int read_flash_to_file(struct flashctx *flash, const char *filename)
 {
 	unsigned long size = flash->chip->total_size * 1024;
-	unsigned char *buf = calloc(size, sizeof(char));
+	unsigned char *buf;
 	int ret = 0;
 
 	msg_cinfo("Reading flash... ");
+#if !defined(__LIBPAYLOAD__) && !IS_WINDOWS
+	/* Without a layout, the whole chip is read and can be streamed. */
+	if (filename && get_layout(flash) == &flash->fallback_layout.base && spi_can_read_pipelined(flash) &&
+	    can_stream_to_file(filename)) {
+		ret = read_flash_to_file_pipelined(flash, filename);
+		msg_cinfo("%s.\n", ret ? "FAILED" : "done");
+		return ret;
+	}
+#endif
+
+	buf = calloc(size, sizeof(char));
 	if (!buf) {
 		msg_gerr("Memory allocation failed!\n");
 		msg_cinfo("FAILED.\n");
@@ -1581,9 +1819,43 @@ struct walk_info {
 	chipoff_t region_end;
 	chipoff_t erase_start;
 	chipoff_t erase_end;
+	/* Write run that may still grow into the following erase block. */
+	chipoff_t write_start;
+	chipsize_t write_len;
+	/* Did we change something or was every erase/write skipped (if any)? */
+	bool all_skipped;
+	/* The chip reports erase failures and a final verify follows, so erased blocks are not read back. */
+	bool trust_erase_status;
 };
 /* returns 0 on success, 1 to retry with another erase function, 2 for immediate abort */
-typedef int (*per_blockfn_t)(struct flashctx *, const struct walk_info *, erasefn_t);
+typedef int (*per_blockfn_t)(struct flashctx *, struct walk_info *, erasefn_t);
+
+/* Writes the pending write run. Its data has to be in `info->curcontents` already. */
+static int flush_pending_write(struct flashctx *const flashctx, struct walk_info *const info)
+{
+	const chipsize_t len = info->write_len;
+
+	info->write_len = 0;
+	if (!len)
+		return 0;
+	/* Needs the partial write function signature. */
+	return flashctx->chip->write(flashctx, info->curcontents + info->write_start, info->write_start, len);
+}
+
+/* Appends a write run to the pending one if contiguous, otherwise writes the pending run first. */
+static int queue_write(struct flashctx *const flashctx, struct walk_info *const info,
+		       const chipoff_t start, const chipsize_t len)
+{
+	if (info->write_len && info->write_start + info->write_len == start) {
+		info->write_len += len;
+		return 0;
+	}
+	if (flush_pending_write(flashctx, info))
+		return 1;
+	info->write_start = start;
+	info->write_len = len;
+	return 0;
+}
 
 static int walk_eraseblocks(struct flashctx *const flashctx,
 			    struct walk_info *const info,
@@ -1595,6 +1867,7 @@ static int walk_eraseblocks(struct flashctx *const flashctx,
 	struct block_eraser *const eraser = &flashctx->chip->block_erasers[erasefunction];
 
 	info->erase_start = 0;
+	info->write_len = 0;
 	for (i = 0; i < NUM_ERASEREGIONS; ++i) {
 		/* count==0 for all automatically initialized array
 		   members so the loop below won't be executed for them. */
@@ -1615,13 +1888,168 @@ static int walk_eraseblocks(struct flashctx *const flashctx,
 			msg_cdbg("0x%06x-0x%06x:", info->erase_start, info->erase_end);
 
 			ret = per_blockfn(flashctx, info, eraser->block_erase);
-			if (ret)
+			if (ret) {
+				/* The caller re-reads the chip before retrying. */
+				info->write_len = 0;
 				return ret;
+			}
 		}
 		if (info->region_end < info->erase_start)
 			break;
 	}
 	msg_cdbg("\n");
+	if (flush_pending_write(flashctx, info))
+		return 1;
+	return 0;
+}
+
+/* Returns true if the included layout regions cover every byte of the chip. */
+static bool layout_covers_chip(const struct flashctx *const flashctx)
+{
+	const struct flashrom_layout *const layout = get_layout(flashctx);
+	const chipoff_t chip_end = flashctx->chip->total_size * 1024 - 1;
+	chipoff_t next = 0;
+
+	while (1) {
+		bool found = false;
+		chipoff_t end = 0;
+		size_t i;
+		for (i = 0; i < layout->num_entries; ++i) {
+			const struct romentry *const entry = &layout->entries[i];
+			if (entry->included && entry->start <= next && entry->end >= next &&
+			    (!found || entry->end > end)) {
+				end = entry->end;
+				found = true;
+			}
+		}
+		if (!found)
+			return false;
+		if (end >= chip_end)
+			return true;
+		next = end + 1;
+	}
+}
+
+/*
+ * Rough typical timings of flash chips, used to decide between erasing
+ * single blocks and erasing the whole chip. Only their relation matters.
+ */
+#define ERASE_BLOCK_BASE_US	30000	/* Fixed cost of a single block erase. */
+#define ERASE_US_PER_KB		2000	/* Erase cost per KiB, also for chip erase. */
+#define PROGRAM_US_PER_KB	3000	/* Programming cost per KiB. */
+
+/*
+ * Decide if erasing the whole chip at once is faster than erasing each block
+ * that needs it with the finest erase function. After a chip erase, blocks
+ * that wouldn't have been erased have to be reprogrammed, which is accounted
+ * for. Only considered if all regions are included, so nothing that is meant
+ * to be preserved can be lost.
+ *
+ * Returns the index of the chip erase function to use or -1.
+ */
+static int select_chip_eraser(const struct flashctx *const flashctx, const struct walk_info *const info)
+{
+	const struct flashchip *const chip = flashctx->chip;
+	const unsigned int chip_size = chip->total_size * 1024;
+	int chip_eraser = -1, block_eraser = -1;
+	unsigned int max_blocks = 0;
+	int k;
+
+	for (k = 0; k < NUM_ERASEFUNCTIONS; k++) {
+		if (check_block_eraser(flashctx, k, 0))
+			continue;
+		const struct eraseblock *const blocks = chip->block_erasers[k].eraseblocks;
+		if (blocks[0].size == chip_size) {
+			if (chip_eraser < 0)
+				chip_eraser = k;
+			continue;
+		}
+		unsigned int i, count = 0;
+		for (i = 0; i < NUM_ERASEREGIONS; i++)
+			count += blocks[i].count;
+		if (count > max_blocks) {
+			max_blocks = count;
+			block_eraser = k;
+		}
+	}
+	if (chip_eraser < 0 || block_eraser < 0 || !layout_covers_chip(flashctx))
+		return -1;
+
+	const uint8_t *const newcontents = info->newcontents;
+	const uint8_t *const curcontents = info->curcontents;
+	const struct eraseblock *const blocks = chip->block_erasers[block_eraser].eraseblocks;
+	unsigned int i, j, addr = 0, erase_count = 0;
+	/* Counted in bytes, so blocks smaller than 1 KiB still add to the cost. */
+	unsigned long long erase_bytes = 0, reprogram_bytes = 0;
+	for (i = 0; i < NUM_ERASEREGIONS; i++) {
+		for (j = 0; j < blocks[i].count; j++, addr += blocks[i].size) {
+			const unsigned int len = blocks[i].size;
+			if (!curcontents || need_erase(curcontents + addr, newcontents + addr, len, chip->gran)) {
+				erase_count++;
+				erase_bytes += len;
+				continue;
+			}
+			/* Content that stays but would be lost by a chip erase. */
+			unsigned int n;
+			for (n = 0; n < len; n++) {
+				if (newcontents[addr + n] != 0xff) {
+					reprogram_bytes += len;
+					break;
+				}
+			}
+		}
+	}
+
+	const unsigned long long block_cost = (unsigned long long)erase_count * ERASE_BLOCK_BASE_US +
+					      erase_bytes * ERASE_US_PER_KB / 1024;
+	const unsigned long long chip_cost = ERASE_BLOCK_BASE_US +
+					     (unsigned long long)chip_size * ERASE_US_PER_KB / 1024 +
+					     reprogram_bytes * PROGRAM_US_PER_KB / 1024;
+	msg_cdbg("%u of %u blocks need erasing, %llu bytes would have to be reprogrammed after chip erase, ",
+		 erase_count, max_blocks, reprogram_bytes);
+	if (chip_cost >= block_cost) {
+		msg_cdbg("erasing by blocks.\n");
+		return -1;
+	}
+	msg_cdbg("erasing whole chip.\n");
+	return chip_eraser;
+}
+
+static int erase_block(struct flashctx *const flashctx,
+		       struct walk_info *const info, const erasefn_t erasefn);
+
+/*
+ * Erase the whole chip up front, if that's estimated to be faster.
+ * Returns 1 if the chip was erased, 0 if it wasn't, and 2 for immediate abort.
+ */
+static int walk_chip_erase(struct flashctx *const flashctx, struct walk_info *const info)
+{
+	const int k = select_chip_eraser(flashctx, info);
+	if (k < 0)
+		return 0;
+
+	struct walk_info chip_info = *info;
+	chip_info.region_start = 0;
+	chip_info.region_end = flashctx->chip->total_size * 1024 - 1;
+	msg_cdbg("Trying chip erase function %i... ", k);
+	const int ret = walk_eraseblocks(flashctx, &chip_info, k, erase_block);
+	info->all_skipped &= chip_info.all_skipped;
+	if (!ret) {
+		if (info->curcontents)
+			memset(info->curcontents, 0xff, flashctx->chip->total_size * 1024);
+		return 1;
+	}
+
+	/* Fall back to erasing by blocks. */
+	msg_cinfo("Looking for another erase function.\n");
+	if (info->curcontents) {
+		msg_cinfo("Reading current flash chip contents... ");
+		if (read_by_layout(flashctx, info->curcontents)) {
+			msg_cerr("Can't read anymore! Aborting.\n");
+			return 2;
+		}
+		msg_cinfo("done. ");
+	}
 	return 0;
 }
 
@@ -1630,9 +2058,24 @@ static int walk_by_layout(struct flashctx *const flashctx, struct walk_info *con
 {
 	const struct flashrom_layout *const layout = get_layout(flashctx);
 
-	all_skipped = true;
+	info->all_skipped = true;
 	msg_cinfo("Erasing and writing flash chip... ");
 
+	switch (walk_chip_erase(flashctx, info)) {
+	case 0:
+		break;
+	case 1:
+		/* Nothing left to do for a plain erase, otherwise only writes follow. */
+		if (!info->curcontents) {
+			msg_cinfo("Erase/write done.\n");
+			return 0;
+		}
+		break;
+	default:
+		msg_cerr("FAILED!\n");
+		return 1;
+	}
+
 	size_t i;
 	for (i = 0; i < layout->num_entries; ++i) {
 		if (!layout->entries[i].included)
@@ -1643,7 +2086,7 @@ static int walk_by_layout(struct flashctx *const flashctx, struct walk_info *con
 
 		size_t j;
 		int error = 1; /* retry as long as it's 1 */
-		for (j = (NUM_ERASEFUNCTIONS - 1); j >= 0; j--) {
+		for (j = 0; j < NUM_ERASEFUNCTIONS; j++) {
 			if (j != 0)
 				msg_cinfo("Looking for another erase function.\n");
 			msg_cdbg("Trying erase function %zi... ", j);
@@ -1674,23 +2117,26 @@ static int walk_by_layout(struct flashctx *const flashctx, struct walk_info *con
 			return 1;
 		}
 	}
-	if (all_skipped)
+	if (info->all_skipped)
 		msg_cinfo("\nWarning: Chip content is identical to the requested image.\n");
 	msg_cinfo("Erase/write done.\n");
 	return 0;
 }
 
 static int erase_block(struct flashctx *const flashctx,
-		       const struct walk_info *const info, const erasefn_t erasefn)
+		       struct walk_info *const info, const erasefn_t erasefn)
 {
 	const unsigned int erase_len = info->erase_end + 1 - info->erase_start;
 
-	all_skipped = false;
+	info->all_skipped = false;
 
 	msg_cdbg("E");
+	flashctx->error_status_checked = false;
 	if (erasefn(flashctx, info->erase_start, erase_len))
 		return 1;
-	if (check_erased_range(flashctx, info->erase_start, erase_len)) {
+	/* Only skip the read-back if the erase function actually looked at the error flags. */
+	if (!(info->trust_erase_status && flashctx->error_status_checked) &&
+	    check_erased_range(flashctx, info->erase_start, erase_len)) {
 		msg_cerr("ERASE FAILED!\n");
 		return 1;
 	}
@@ -1714,8 +2160,73 @@ static int erase_by_layout(struct flashctx *const flashctx)
 	return walk_by_layout(flashctx, &info, &erase_block);
 }
 
+/*
+ * Default cost of one more write command in bytes of data transfer. It
+ * covers WREN, opcode and address, the chip's program time and RDSR polling.
+ */
+#define DEFAULT_WRITE_CMD_COST 1024
+
+/* Number of program commands spi_write_chunked() needs for the given range. */
+static unsigned int count_write_cmds(const unsigned int start, const unsigned int len,
+				     const unsigned int page_size, const unsigned int chunk)
+{
+	unsigned int cmds = 0, pos = start;
+
+	while (pos < start + len) {
+		const unsigned int page_end = (pos / page_size + 1) * page_size;
+		const unsigned int inpage = min(start + len, page_end) - pos;
+		cmds += (inpage + chunk - 1) / chunk;
+		pos += inpage;
+	}
+	return cmds;
+}
+
+/*
+ * Decide if two write runs should be merged into one that also programs the
+ * gap between them. The gap must be erased, so programming its 0xff bytes is
+ * a no-op. Splitting saves the transfer of the gap, but may cost additional
+ * program commands if both runs touch the same page (or write chunk). The
+ * cost of a command is taken from the master's cost model.
+ *
+ * Only applies to page programming where commands can be counted, other
+ * write functions keep the runs split.
+ */
+static bool should_merge_writes(const struct flashctx *const flash, const uint8_t *const have,
+				const unsigned int first_start, const unsigned int first_len,
+				const unsigned int next_start, const unsigned int next_len)
+{
+	const unsigned int page_size = flash->chip->page_size;
+	const unsigned int gap_start = first_start + first_len;
+	unsigned int i, chunk = page_size;
+
+	if (flash->chip->write != spi_chip_write_256 || !page_size)
+		return false;
+	for (i = gap_start; i < next_start; i++) {
+		if (have[i] != 0xff)
+			return false;
+	}
+
+	unsigned int cmd_cost = DEFAULT_WRITE_CMD_COST;
+	if (flash->mst->buses_supported & BUS_SPI) {
+		if (flash->mst->spi.write_cmd_cost)
+			cmd_cost = flash->mst->spi.write_cmd_cost;
+		if (flash->mst->spi.write_256 == default_spi_write_256 && flash->mst->spi.max_data_write)
+			chunk = min(chunk, flash->mst->spi.max_data_write);
+	}
+
+	const unsigned int merged_len = next_start + next_len - first_start;
+	const unsigned long split_cost =
+		(unsigned long)(count_write_cmds(first_start, first_len, page_size, chunk) +
+				count_write_cmds(next_start, next_len, page_size, chunk)) * cmd_cost +
+		first_len + next_len;
+	const unsigned long merged_cost =
+		(unsigned long)count_write_cmds(first_start, merged_len, page_size, chunk) * cmd_cost +
+		merged_len;
+	return merged_cost < split_cost;
+}
+
 static int read_erase_write_block(struct flashctx *const flashctx,
-				  const struct walk_info *const info, const erasefn_t erasefn)
+				  struct walk_info *const info, const erasefn_t erasefn)
 {
 	const chipsize_t erase_len = info->erase_end + 1 - info->erase_start;
 	const bool region_unaligned = info->region_start > info->erase_start ||
@@ -1782,19 +2293,39 @@ static int read_erase_write_block(struct flashctx *const flashctx,
 	/* get_next_write() sets starthere to a new value after the call. */
 	while ((lenhere = get_next_write(curcontents + starthere, newcontents + starthere,
 					 erase_len - starthere, &starthere, flashctx->chip->gran))) {
+		/* Merge following runs as long as that's cheaper than another write. */
+		while (starthere + lenhere < erase_len) {
+			unsigned int nextstart = starthere + lenhere;
+			const unsigned int nextlen = get_next_write(curcontents + nextstart,
+								    newcontents + nextstart, erase_len - nextstart,
+								    &nextstart, flashctx->chip->gran);
+			if (!nextlen || !should_merge_writes(flashctx, curcontents - info->erase_start,
+							    info->erase_start + starthere, lenhere,
+							    info->erase_start + nextstart, nextlen))
+				break;
+			lenhere = nextstart + nextlen - starthere;
+		}
 		if (!writecount++)
 			msg_cdbg("W");
-		/* Needs the partial write function signature. */
-		if (flashctx->chip->write(flashctx, newcontents + starthere,
-					  info->erase_start + starthere, lenhere))
+		/*
+		 * get_next_write() never looks back, so `curcontents` can be
+		 * updated right away. Writes are issued from there, which
+		 * lets a run continue into the following erase blocks.
+		 */
+		memcpy(curcontents + starthere, newcontents + starthere, lenhere);
+		if (queue_write(flashctx, info, info->erase_start + starthere, lenhere))
 			goto _free_ret;
 		starthere += lenhere;
 		skipped = false;
 	}
+	/* Only a run that reaches the end of this block can grow any further. */
+	if (info->write_len && info->write_start + info->write_len != info->erase_end + 1 &&
+	    flush_pending_write(flashctx, info))
+		goto _free_ret;
 	if (skipped)
 		msg_cdbg("S");
 	else
-		all_skipped = false;
+		info->all_skipped = false;
 
 	/* Update curcontents, other regions with overlapping erase blocks
 	   might rely on this. */
@@ -1816,16 +2347,22 @@ _free_ret:
  * @param flashctx    Flash context to be used.
  * @param curcontents A buffer of full chip size with current chip contents of included regions.
  * @param newcontents The new image to be written.
+ * @param all_skipped Set to whether every erase and write was skipped.
  * @return 0 on success,
  *	   1 if anything has gone wrong.
  */
 static int write_by_layout(struct flashctx *const flashctx,
-			   void *const curcontents, const void *const newcontents)
+			   void *const curcontents, const void *const newcontents,
+			   bool *const all_skipped)
 {
-	struct walk_info info;
+	struct walk_info info = { 0 };
 	info.curcontents = curcontents;
 	info.newcontents = newcontents;
-	return walk_by_layout(flashctx, &info, read_erase_write_block);
+	info.trust_erase_status = (flashctx->chip->feature_bits & FEATURE_ERR_STATUS) &&
+				  flashctx->flags.verify_after_write;
+	const int ret = walk_by_layout(flashctx, &info, read_erase_write_block);
+	*all_skipped = info.all_skipped;
+	return ret;
 }
 
 /**
@@ -2219,6 +2756,8 @@ int prepare_flash_access(struct flashctx *const flash,
 
 	flash->address_high_byte = -1;
 	flash->in_4ba_mode = false;
+	flash->error_status_unavailable = false;
+	flash->read_only_access = read_it && !write_it && !erase_it && !verify_it;
 
 	/* Enable/disable 4-byte addressing mode if flash chip supports it */
 	if (flash->chip->feature_bits & (FEATURE_4BA_ENTER | FEATURE_4BA_ENTER_WREN)) {
@@ -2355,6 +2894,7 @@ int flashrom_image_write(struct flashctx *const flashctx, void *const buffer, co
 		return 4;
 
 	int ret = 1;
+	bool all_skipped = true;
 
 	uint8_t *const newcontents = buffer;
 	uint8_t *const curcontents = malloc(flash_size);
@@ -2403,7 +2943,7 @@ int flashrom_image_write(struct flashctx *const flashctx, void *const buffer, co
 	}
 	msg_cinfo("done.\n");
 
-	if (write_by_layout(flashctx, curcontents, newcontents)) {
+	if (write_by_layout(flashctx, curcontents, newcontents, &all_skipped)) {
 		msg_cerr("Uh oh. Erase/write failed. ");
 		ret = 2;
 		if (verify_all) {
@@ -2577,3 +3117,194 @@ _free_ret:
 	free(newcontents);
 	return ret;
 }
+
+#define STRESS_PATTERNS		14
+#define STRESS_MAX_ERRORS	8
+
+/* What the patterns of generate_testpattern() are good at, see there. */
+static const char *const stress_class_names[] = {
+	"communication slips", "AND/block number", "aliasing < 256 B",
+	"aliasing > 256 B", "solid 00/ff",
+};
+static const unsigned int stress_pattern_class[STRESS_PATTERNS] = { 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 3, 3, 4, 4 };
+static const unsigned int stress_transfer_sizes[] = { 16, 256, 4096, 65536 };
+
+static unsigned long stress_kbps(unsigned long bytes, const struct timeval *start)
+{
+	struct timeval end;
+	gettimeofday(&end, NULL);
+	const unsigned long long us = (end.tv_sec - start->tv_sec) * 1000000ULL + end.tv_usec - start->tv_usec;
+	return us ? bytes * 1000000ULL / 1024 / us : 0;
+}
+
+/* Reads the included regions in chunks of at most `chunk` bytes. */
+static int stress_read_back(struct flashctx *const flash, uint8_t *const buf,
+			    const unsigned int chunk, unsigned long *const bytes)
+{
+	const struct flashrom_layout *const layout = get_layout(flash);
+	size_t i;
+
+	for (i = 0; i < layout->num_entries; ++i) {
+		if (!layout->entries[i].included)
+			continue;
+
+		chipoff_t addr;
+		const chipoff_t end = layout->entries[i].end;
+		for (addr = layout->entries[i].start; addr <= end; addr += chunk) {
+			const unsigned int len = min(chunk, end - addr + 1);
+			if (flash->chip->read(flash, buf + addr, addr, len))
+				return 1;
+			*bytes += len;
+		}
+	}
+	return 0;
+}
+
+/* Counts the mismatches in the included regions and prints the first few. */
+static unsigned int stress_check(struct flashctx *const flash, const uint8_t *const buf,
+				 const uint8_t *const expected)
+{
+	const struct flashrom_layout *const layout = get_layout(flash);
+	unsigned int errors = 0;
+	size_t i;
+
+	for (i = 0; i < layout->num_entries; ++i) {
+		if (!layout->entries[i].included)
+			continue;
+
+		chipoff_t addr;
+		for (addr = layout->entries[i].start; addr <= layout->entries[i].end; addr++) {
+			if (buf[addr] == expected[addr])
+				continue;
+			if (errors < STRESS_MAX_ERRORS)
+				msg_cinfo("    0x%06x: expected 0x%02x, read 0x%02x\n",
+					  addr, expected[addr], buf[addr]);
+			errors++;
+		}
+	}
+	return errors;
+}
+
+/*
+ * Writes each pattern of generate_testpattern() to the included layout regions
+ * and reads it back with several transfer sizes. Reports the throughput and
+ * every mismatch found. The original contents are restored in the end.
+ */
+int do_stress(struct flashctx *const flash)
+{
+	const size_t flash_size = flash->chip->total_size * 1024;
+	unsigned int failed_classes = 0;
+	struct timeval start;
+	bool all_skipped;
+	int ret = 1;
+	size_t i;
+	int pattern;
+
+	if (get_layout(flash) == &flash->fallback_layout.base && !flash->flags.force) {
+		msg_cerr("The stress test overwrites the flash, select a scratch region with -l/--ifd and -i\n"
+			 "or use --force to use the whole chip.\n");
+		return 1;
+	}
+
+	uint8_t *const oldcontents = malloc(flash_size);
+	uint8_t *const curcontents = malloc(flash_size);
+	uint8_t *const newcontents = malloc(flash_size);
+	/* Read-backs go to their own buffer, a bad read mustn't become the write model of the chip. */
+	uint8_t *const readcontents = malloc(flash_size);
+	if (!oldcontents || !curcontents || !newcontents || !readcontents) {
+		msg_gerr("Out of memory!\n");
+		goto _free_ret;
+	}
+
+	if (prepare_flash_access(flash, true, true, false, true))
+		goto _free_ret;
+
+	msg_cinfo("Reading old flash chip contents... ");
+	memset(oldcontents, 0xff, flash_size);
+	if (read_by_layout(flash, oldcontents)) {
+		msg_cinfo("FAILED.\n");
+		goto _finalize_ret;
+	}
+	msg_cinfo("done.\n");
+	memcpy(curcontents, oldcontents, flash_size);
+
+	for (pattern = 0; pattern < STRESS_PATTERNS; pattern++) {
+		unsigned long bytes = 0;
+
+		generate_testpattern(newcontents, flash_size, pattern);
+		msg_cinfo("Pattern %2d (%s):\n", pattern, stress_class_names[stress_pattern_class[pattern]]);
+
+		gettimeofday(&start, NULL);
+		if (write_by_layout(flash, curcontents, newcontents, &all_skipped)) {
+			msg_cinfo("  Writing FAILED.\n");
+			failed_classes |= 1 << stress_pattern_class[pattern];
+			goto _reread;
+		}
+		for (i = 0; i < get_layout(flash)->num_entries; i++) {
+			const struct romentry *const entry = &get_layout(flash)->entries[i];
+			if (entry->included)
+				bytes += entry->end - entry->start + 1;
+		}
+		msg_cinfo("  Written at %lu kB/s.\n", stress_kbps(bytes, &start));
+
+		for (i = 0; i < ARRAY_SIZE(stress_transfer_sizes); i++) {
+			bytes = 0;
+			gettimeofday(&start, NULL);
+			if (stress_read_back(flash, readcontents, stress_transfer_sizes[i], &bytes)) {
+				msg_cinfo("  Reading in %u B transfers FAILED.\n", stress_transfer_sizes[i]);
+				failed_classes |= 1 << stress_pattern_class[pattern];
+				goto _reread;
+			}
+			msg_cinfo("  Read in %u B transfers at %lu kB/s.\n", stress_transfer_sizes[i],
+				  stress_kbps(bytes, &start));
+
+			const unsigned int errors = stress_check(flash, readcontents, newcontents);
+			if (errors) {
+				msg_cinfo("  %u bytes differ.\n", errors);
+				failed_classes |= 1 << stress_pattern_class[pattern];
+			}
+		}
+	}
+	goto _restore;
+
+_reread:
+	/* The chip's state is unknown after a failure, start the restore from what it holds now. */
+	msg_cinfo("Reading current flash chip contents... ");
+	if (read_by_layout(flash, curcontents)) {
+		msg_cinfo("FAILED.\n");
+		msg_cerr("Can't restore the old contents.\n");
+		emergency_help_message();
+		goto _finalize_ret;
+	}
+	msg_cinfo("done.\n");
+
+_restore:
+	msg_cinfo("Restoring old flash chip contents.\n");
+	if (write_by_layout(flash, curcontents, oldcontents, &all_skipped) ||
+	    verify_by_layout(flash, curcontents, oldcontents)) {
+		msg_cerr("Restoring FAILED.\n");
+		emergency_help_message();
+		goto _finalize_ret;
+	}
+
+	if (failed_classes) {
+		msg_cinfo("Failed pattern classes:");
+		for (i = 0; i < ARRAY_SIZE(stress_class_names); i++) {
+			if (failed_classes & (1 << i))
+				msg_cinfo(" \"%s\"", stress_class_names[i]);
+		}
+		msg_cinfo("\n");
+	} else {
+		msg_cinfo("All patterns passed.\n");
+		ret = 0;
+	}
+
+_finalize_ret:
+	finalize_flash_access(flash);
+_free_ret:
+	free(readcontents);
+	free(newcontents);
+	free(curcontents);
+	free(oldcontents);
+	return ret;
+}
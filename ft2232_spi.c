@@ -103,6 +103,13 @@ static uint8_t cs_bits = 0x08;
 static uint8_t pindir = 0x0b;
 static struct ftdi_context ftdic_context;
 
+/* SPI clock in kHz if the MPSSE can clock without transferring data ('H' chips only), else 0. */
+static unsigned int delay_clk_khz = 0;
+/* Delay for the MPSSE to do before the next command, in SCK cycles. */
+static unsigned int stored_delay_clks = 0;
+/* One "clock for n bytes" command covers up to 65536 bytes. */
+#define MAX_DELAY_CLKS (65536 * 8)
+
 static const char *get_ft2232_devicename(int ft2232_vid, int ft2232_type)
 {
 	int i;
@@ -156,17 +163,24 @@ static int ft2232_spi_send_command(struct flashctx *flash,
 				   unsigned int writecnt, unsigned int readcnt,
 				   const unsigned char *writearr,
 				   unsigned char *readarr);
+static int ft2232_spi_read_submit(struct flashctx *flash, struct spi_read_request *req);
+static int ft2232_spi_read_complete(struct flashctx *flash, struct spi_read_request *req);
 
 static const struct spi_master spi_master_ft2232 = {
 	.type		= SPI_CONTROLLER_FT2232,
 	.features	= SPI_MASTER_4BA,
 	.max_data_read	= 64 * 1024,
 	.max_data_write	= 256,
+	.write_cmd_cost	= 4096, /* USB round trips for WREN, program and RDSR polling */
 	.command	= ft2232_spi_send_command,
 	.multicommand	= default_spi_send_multicommand,
 	.read		= default_spi_read,
 	.write_256	= default_spi_write_256,
 	.write_aai	= default_spi_write_aai,
+	/* Only a few command bytes per read have to fit into the chip's TX buffer. */
+	.max_reads_queued = 4,
+	.read_submit	= ft2232_spi_read_submit,
+	.read_complete	= ft2232_spi_read_complete,
 };
 
 /* Returns 0 upon success, a negative number upon errors. */
@@ -401,6 +415,8 @@ int ft2232_spi_init(void)
 
 	msg_pdbg("MPSSE clock: %f MHz, divisor: %u, SPI clock: %f MHz\n",
 		 mpsse_clk, divisor, (double)(mpsse_clk / divisor));
+	delay_clk_khz = clock_5x ? 60000 / divisor : 0;
+	stored_delay_clks = 0;
 
 	/* Disconnect TDI/DO to TDO/DI for loopback. */
 	msg_pdbg("No loopback of TDI/DO TDO/DI\n");
@@ -430,6 +446,35 @@ ftdi_err:
 	return ret;
 }
 
+/*
+ * Delays are done by the MPSSE right before the next command instead of on the
+ * host, so they don't split command sequences into separate USB transfers.
+ */
+void ft2232_spi_delay(unsigned int usecs)
+{
+	const unsigned long long clks = ((unsigned long long)usecs * delay_clk_khz + 999) / 1000;
+
+	if (!delay_clk_khz || stored_delay_clks + clks > MAX_DELAY_CLKS) {
+		internal_delay(usecs);
+		return;
+	}
+	stored_delay_clks += clks;
+}
+
+/* Queues the stored delay as clock cycles without data transfer (CS# stays deasserted). */
+static int put_delay(unsigned char *buf)
+{
+	if (!stored_delay_clks)
+		return 0;
+
+	const unsigned int bytes = (stored_delay_clks + 7) / 8;
+	stored_delay_clks = 0;
+	buf[0] = 0x8f; /* Clock for n x 8 bits with no data transfer. CLK_BYTES in newer libftdi */
+	buf[1] = (bytes - 1) & 0xff;
+	buf[2] = ((bytes - 1) >> 8) & 0xff;
+	return 3;
+}
+
 /* Returns 0 upon success, a negative number upon errors. */
 static int ft2232_spi_send_command(struct flashctx *flash,
 				   unsigned int writecnt, unsigned int readcnt,
@@ -447,7 +492,7 @@ static int ft2232_spi_send_command(struct flashctx *flash,
 		return SPI_INVALID_LENGTH;
 
 	/* buf is not used for the response from the chip. */
-	bufsize = max(writecnt + 9, 260 + 9);
+	bufsize = max(writecnt + 12, 260 + 12);
 	/* Never shrink. realloc() calls are expensive. */
 	if (bufsize > oldbufsize) {
 		buf = realloc(buf, bufsize);
@@ -465,6 +510,8 @@ static int ft2232_spi_send_command(struct flashctx *flash,
 	 * and deassert CS# all in one shot. If reading, we do three separate
 	 * operations.
 	 */
+	i += put_delay(buf);
+
 	msg_pspew("Assert CS#\n");
 	buf[i++] = SET_BITS_LOW;
 	buf[i++] = 0 & ~cs_bits; /* assertive */
@@ -518,4 +565,45 @@ static int ft2232_spi_send_command(struct flashctx *flash,
 	return failed ? -1 : 0;
 }
 
+/*
+ * Queue a complete read sequence (CS# assertion, opcode and address, read and
+ * CS# deassertion) with the MPSSE. The MPSSE keeps executing queued commands
+ * while we fetch the results of earlier ones, so consecutive reads don't wait
+ * for a USB round trip each.
+ */
+static int ft2232_spi_read_submit(struct flashctx *flash, struct spi_read_request *req)
+{
+	struct ftdi_context *ftdic = &ftdic_context;
+	unsigned char buf[3 + 3 + 3 + sizeof(req->writearr) + 3 + 3];
+	int i = 0;
+
+	if (req->writecnt == 0 || req->writecnt > sizeof(req->writearr) ||
+	    req->readcnt == 0 || req->readcnt > 65536)
+		return SPI_INVALID_LENGTH;
+
+	msg_pspew("Queue read of %u bytes\n", req->readcnt);
+	i += put_delay(buf);
+	buf[i++] = SET_BITS_LOW;
+	buf[i++] = 0 & ~cs_bits; /* assertive */
+	buf[i++] = pindir;
+	buf[i++] = MPSSE_DO_WRITE | MPSSE_WRITE_NEG;
+	buf[i++] = (req->writecnt - 1) & 0xff;
+	buf[i++] = ((req->writecnt - 1) >> 8) & 0xff;
+	memcpy(buf + i, req->writearr, req->writecnt);
+	i += req->writecnt;
+	buf[i++] = MPSSE_DO_READ;
+	buf[i++] = (req->readcnt - 1) & 0xff;
+	buf[i++] = ((req->readcnt - 1) >> 8) & 0xff;
+	buf[i++] = SET_BITS_LOW;
+	buf[i++] = cs_bits;
+	buf[i++] = pindir;
+
+	return send_buf(ftdic, buf, i) ? SPI_GENERIC_ERROR : 0;
+}
+
+static int ft2232_spi_read_complete(struct flashctx *flash, struct spi_read_request *req)
+{
+	return get_buf(&ftdic_context, req->readarr, req->readcnt) ? SPI_GENERIC_ERROR : 0;
+}
+
 #endif
@@ -66,11 +66,13 @@ static void gfxnvidia_chip_writeb(const struct flashctx *flash, uint8_t val,
 				  chipaddr addr);
 static uint8_t gfxnvidia_chip_readb(const struct flashctx *flash,
 				    const chipaddr addr);
+static void gfxnvidia_chip_readn(const struct flashctx *flash, uint8_t *buf,
+				 const chipaddr addr, size_t len);
 static const struct par_master par_master_gfxnvidia = {
 		.chip_readb		= gfxnvidia_chip_readb,
 		.chip_readw		= fallback_chip_readw,
 		.chip_readl		= fallback_chip_readl,
-		.chip_readn		= fallback_chip_readn,
+		.chip_readn		= gfxnvidia_chip_readn,
 		.chip_writeb		= gfxnvidia_chip_writeb,
 		.chip_writew		= fallback_chip_writew,
 		.chip_writel		= fallback_chip_writel,
@@ -82,7 +84,7 @@ int gfxnvidia_init(void)
 	struct pci_dev *dev = NULL;
 	uint32_t reg32;
 
-	if (rget_io_perms())
+	if (rget_byte_io_perms())
 		return 1;
 
 	dev = pcidev_init(gfx_nvidia, PCI_BASE_ADDRESS_0);
@@ -123,3 +125,18 @@ static uint8_t gfxnvidia_chip_readb(const struct flashctx *flash,
 {
 	return pci_mmio_readb(nvidia_bar + (addr & GFXNVIDIA_MEMMAP_MASK));
 }
+
+static void gfxnvidia_chip_readn(const struct flashctx *flash, uint8_t *buf,
+				 const chipaddr addr, size_t len)
+{
+	chipaddr pos = addr;
+
+	/* Copy straight from the window, splitting only where the address wraps around. */
+	while (len) {
+		const size_t chunk = min(len, GFXNVIDIA_MEMMAP_MASK + 1 - (pos & GFXNVIDIA_MEMMAP_MASK));
+		mmio_readn(nvidia_bar + (pos & GFXNVIDIA_MEMMAP_MASK), buf, chunk);
+		pos += chunk;
+		buf += chunk;
+		len -= chunk;
+	}
+}
@@ -61,6 +61,114 @@
 int io_fd;
 #endif
 
+#if NEED_RAW_ACCESS == 1 && IS_X86 && defined(__linux__) && !defined(__ANDROID__)
+#define USE_DEV_PORT 1
+#else
+#define USE_DEV_PORT 0
+#endif
+
+#if USE_DEV_PORT
+/*
+ * If iopl() is not permitted (e.g. in some virtualized setups), port I/O can
+ * still go through /dev/port. Each access costs a syscall there, and the
+ * kernel splits accesses wider than a byte into byte accesses. That changes
+ * what the device sees, so only rget_byte_io_perms() falls back to it and
+ * word/dword accesses fail while it is in use.
+ */
+static int dev_port_fd = -1;
+
+static int close_dev_port(void *p)
+{
+	close(dev_port_fd);
+	dev_port_fd = -1;
+	return 0;
+}
+
+static void dev_port_write(const void *buf, size_t len, uint16_t port)
+{
+	if (pwrite(dev_port_fd, buf, len, port) != (ssize_t)len)
+		msg_perr("Writing to I/O port 0x%04x failed: %s\n", port, strerror(errno));
+}
+
+static void dev_port_read(void *buf, size_t len, uint16_t port)
+{
+	if (pread(dev_port_fd, buf, len, port) != (ssize_t)len) {
+		msg_perr("Reading from I/O port 0x%04x failed: %s\n", port, strerror(errno));
+		memset(buf, 0xff, len);
+	}
+}
+
+/* Returns true (after printing an error) if a wider than byte access would have to go through /dev/port. */
+static bool dev_port_refuse_wide(unsigned int bits, uint16_t port)
+{
+	if (dev_port_fd < 0)
+		return false;
+	msg_perr("%u-bit access to I/O port 0x%04x is not possible through /dev/port.\n", bits, port);
+	return true;
+}
+
+bool io_wide_ok(void)
+{
+	return dev_port_fd < 0;
+}
+
+void io_outb(uint8_t value, uint16_t port)
+{
+	if (dev_port_fd < 0)
+		outb(value, port);
+	else
+		dev_port_write(&value, sizeof(value), port);
+}
+
+void io_outw(uint16_t value, uint16_t port)
+{
+	if (!dev_port_refuse_wide(16, port))
+		outw(value, port);
+}
+
+void io_outl(uint32_t value, uint16_t port)
+{
+	if (!dev_port_refuse_wide(32, port))
+		outl(value, port);
+}
+
+uint8_t io_inb(uint16_t port)
+{
+	uint8_t value;
+
+	if (dev_port_fd < 0)
+		return inb(port);
+	dev_port_read(&value, sizeof(value), port);
+	return value;
+}
+
+uint16_t io_inw(uint16_t port)
+{
+	if (dev_port_refuse_wide(16, port))
+		return 0xffff;
+	return inw(port);
+}
+
+uint32_t io_inl(uint16_t port)
+{
+	if (dev_port_refuse_wide(32, port))
+		return 0xffffffff;
+	return inl(port);
+}
+
+/* Both bytes go out with a single syscall on /dev/port. */
+void io_outb_pair(uint8_t first, uint8_t second, uint16_t port)
+{
+	if (dev_port_fd < 0) {
+		outb(first, port);
+		outb(second, port + 1);
+	} else {
+		const uint8_t buf[2] = { first, second };
+		dev_port_write(buf, sizeof(buf), port);
+	}
+}
+#endif
+
 /* Prevent reordering and/or merging of reads/writes to hardware.
  * Such reordering and/or merging would break device accesses which depend on the exact access order.
  */
@@ -109,7 +217,7 @@ static int release_io_perms(void *p)
 #endif
 
 /* Get I/O permissions with automatic permission release on shutdown. */
-int rget_io_perms(void)
+static int get_io_perms(bool byte_only)
 {
 #if IS_X86 && !(defined(__DJGPP__) || defined(__LIBPAYLOAD__))
 #if defined (__sun)
@@ -120,6 +228,21 @@ int rget_io_perms(void)
 	if (ioperm(0, 65536, 1) != 0) {
 #elif USE_IOPL
 	if (iopl(3) != 0) {
+#endif
+#if USE_DEV_PORT
+		const int iopl_errno = errno;
+		if (byte_only)
+			dev_port_fd = open("/dev/port", O_RDWR);
+		if (dev_port_fd >= 0) {
+			msg_pdbg("iopl() failed (%s), using /dev/port for I/O port access.\n",
+				 strerror(iopl_errno));
+			if (register_shutdown(close_dev_port, NULL)) {
+				close_dev_port(NULL);
+				return 1;
+			}
+			return 0;
+		}
+		errno = iopl_errno;
 #endif
 		msg_perr("ERROR: Could not get I/O privileges (%s).\n", strerror(errno));
 		msg_perr("You need to be root.\n");
@@ -131,8 +254,9 @@ int rget_io_perms(void)
 			 "that your kernel configuration has the option INSECURE enabled.\n");
 #endif
 		return 1;
-	} else {
-		register_shutdown(release_io_perms, NULL);
+	} else if (register_shutdown(release_io_perms, NULL)) {
+		release_io_perms(NULL);
+		return 1;
 	}
 #else
 	/* DJGPP and libpayload environments have full PCI port I/O permissions by default. */
@@ -141,6 +265,18 @@ int rget_io_perms(void)
 	return 0;
 }
 
+/* For callers that need word or dword port accesses. */
+int rget_io_perms(void)
+{
+	return get_io_perms(false);
+}
+
+/* For callers that do byte port accesses only, which also work through /dev/port. */
+int rget_byte_io_perms(void)
+{
+	return get_io_perms(true);
+}
+
 void mmio_writeb(uint8_t val, void *addr)
 {
 	*(volatile uint8_t *) addr = val;
@@ -210,55 +346,66 @@ uint32_t mmio_le_readl(const void *addr)
 	return le_to_cpu32(mmio_readl(addr));
 }
 
+/* Read len bytes from a block of little-endian 32-bit registers, one dword access per four bytes. */
+void mmio_le_readn32(const void *addr, uint8_t *buf, size_t len)
+{
+	size_t i;
+
+	for (i = 0; i < len; i += 4) {
+		const uint32_t val = mmio_le_readl((const uint8_t *)addr + i);
+		size_t j;
+
+		for (j = 0; j < 4 && i + j < len; j++)
+			buf[i + j] = (val >> (j * 8)) & 0xff;
+	}
+}
+
+/* Write len bytes to a block of little-endian 32-bit registers. A partial last dword is zero-padded. */
+void mmio_le_writen32(void *addr, const uint8_t *buf, size_t len)
+{
+	size_t i;
+
+	for (i = 0; i < len; i += 4) {
+		uint32_t val = 0;
+		size_t j;
+
+		for (j = 0; j < 4 && i + j < len; j++)
+			val |= (uint32_t)buf[i + j] << (j * 8);
+		mmio_le_writel(val, (uint8_t *)addr + i);
+	}
+}
+
 enum mmio_write_type {
 	mmio_write_type_b,
 	mmio_write_type_w,
 	mmio_write_type_l,
 };
 
-struct undo_mmio_write_data {
-	void *addr;
-	int reg;
-	enum mmio_write_type type;
-	union {
-		uint8_t bdata;
-		uint16_t wdata;
-		uint32_t ldata;
-	};
-};
-
-int undo_mmio_write(void *p)
+static int undo_mmio_write(const struct undo_entry *entry)
 {
-	struct undo_mmio_write_data *data = p;
-	msg_pdbg("Restoring MMIO space at %p\n", data->addr);
-	switch (data->type) {
+	void *const addr = (void *)(uintptr_t)entry->addr;
+
+	msg_pdbg("Restoring MMIO space at %p\n", addr);
+	switch (entry->type) {
 	case mmio_write_type_b:
-		mmio_writeb(data->bdata, data->addr);
+		mmio_writeb(entry->val, addr);
 		break;
 	case mmio_write_type_w:
-		mmio_writew(data->wdata, data->addr);
+		mmio_writew(entry->val, addr);
 		break;
 	case mmio_write_type_l:
-		mmio_writel(data->ldata, data->addr);
+		mmio_writel(entry->val, addr);
 		break;
 	}
-	/* p was allocated in register_undo_mmio_write. */
-	free(p);
 	return 0;
 }
 
 #define register_undo_mmio_write(a, c)					\
 {									\
-	struct undo_mmio_write_data *undo_mmio_write_data;		\
-	undo_mmio_write_data = malloc(sizeof(struct undo_mmio_write_data)); \
-	if (!undo_mmio_write_data) {					\
-		msg_gerr("Out of memory!\n");				\
-		exit(1);						\
-	}								\
-	undo_mmio_write_data->addr = a;					\
-	undo_mmio_write_data->type = mmio_write_type_##c;		\
-	undo_mmio_write_data->c##data = mmio_read##c(a);		\
-	register_shutdown(undo_mmio_write, undo_mmio_write_data);	\
+	struct undo_entry *undo_entry;					\
+	undo_entry = register_undo(undo_mmio_write, (uintptr_t)a, mmio_write_type_##c); \
+	if (undo_entry)							\
+		undo_entry->val = mmio_read##c(a);			\
 }
 
 #define register_undo_mmio_writeb(a) register_undo_mmio_write(a, b)
@@ -186,6 +186,25 @@ cpu_to_be(64)
     #include <DirectHW/DirectHW.h>
 #endif
 
+#if defined(__linux__) && !defined(__ANDROID__)
+  /* Like the glibc interface, but can fall back to /dev/port if iopl() is not permitted. */
+  void io_outb(uint8_t value, uint16_t port);
+  void io_outw(uint16_t value, uint16_t port);
+  void io_outl(uint32_t value, uint16_t port);
+  uint8_t io_inb(uint16_t port);
+  uint16_t io_inw(uint16_t port);
+  uint32_t io_inl(uint16_t port);
+  void io_outb_pair(uint8_t first, uint8_t second, uint16_t port);
+  bool io_wide_ok(void);
+  #define OUTB_PAIR io_outb_pair
+  #define IO_WIDE_OK io_wide_ok
+  #define OUTB io_outb
+  #define OUTW io_outw
+  #define OUTL io_outl
+  #define INB  io_inb
+  #define INW  io_inw
+  #define INL  io_inl
+#else
   /* This is the usual glibc interface. */
   #define OUTB outb
   #define OUTW outw
@@ -196,6 +215,7 @@ cpu_to_be(64)
 #endif
 #endif
 #endif
+#endif
 
 #if defined(__NetBSD__) || defined (__OpenBSD__)
   #if defined(__i386__) || defined(__x86_64__)
@@ -253,6 +273,16 @@ static inline uint32_t inl(uint16_t port)
   #endif
 #endif
 
+#ifndef OUTB_PAIR
+/* Writes `first` to `port` and `second` to `port + 1`, e.g. to an index/data register pair. */
+#define OUTB_PAIR(first, second, port) do { OUTB(first, port); OUTB(second, (port) + 1); } while (0)
+#endif
+
+#ifndef IO_WIDE_OK
+/* False if OUTW/OUTL/INW/INL would fail because port I/O only works bytewise (see rget_byte_io_perms()). */
+#define IO_WIDE_OK() true
+#endif
+
 #if !(defined(__MACH__) && defined(__APPLE__)) && !defined(__FreeBSD__) && !defined(__FreeBSD_kernel__) && !defined(__DragonFly__) && !defined(__LIBPAYLOAD__)
 typedef struct { uint32_t hi, lo; } msr_t;
 msr_t rdmsr(int addr);
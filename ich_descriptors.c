@@ -922,8 +922,10 @@ int read_ich_descriptors_from_dump(const uint32_t *const dump, const size_t len,
 	if (dump == NULL || desc == NULL)
 		return ICH_RET_PARAM;
 
+	if (len < 4 * 4)
+		return ICH_RET_OOB;
 	if (dump[0] != DESCRIPTOR_MODE_SIGNATURE) {
-		if (dump[4] == DESCRIPTOR_MODE_SIGNATURE)
+		if (len >= 5 * 4 && dump[4] == DESCRIPTOR_MODE_SIGNATURE)
 			pch_bug_offset = 4;
 		else
 			return ICH_RET_ERR;
@@ -964,6 +966,8 @@ int read_ich_descriptors_from_dump(const uint32_t *const dump, const size_t len,
 		desc->master.FLMSTRs[i] = dump[(getFMBA(&desc->content) >> 2) + i];
 
 	/* upper map */
+	if (len < UPPER_MAP_OFFSET + 4)
+		return ICH_RET_OOB;
 	desc->upper.FLUMAP1 = dump[(UPPER_MAP_OFFSET >> 2) + 0];
 
 	/* VTL is 8 bits long. Quote from the Ibex Peak SPI programming guide:
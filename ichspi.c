@@ -474,9 +474,33 @@ static uint8_t lookup_spi_type(uint8_t opcode)
 	return 0xFF;
 }
 
+/* Last use of each OPMENU slot, to replace the least recently used one. */
+static unsigned int opcode_last_use[8];
+static unsigned int opcode_use_clock = 0;
+
+static void note_opcode_use(int oppos)
+{
+	opcode_last_use[oppos] = ++opcode_use_clock;
+}
+
+/* Opcodes needed by nearly every operation are never replaced. WREN and
+ * EWSR live in the separate preop registers and stay anyway. */
+static bool opcode_is_pinned(uint8_t opcode)
+{
+	switch (opcode) {
+	case JEDEC_RDSR:
+	case JEDEC_READ:
+	case JEDEC_BYTE_PROGRAM:
+		return true;
+	default:
+		return false;
+	}
+}
+
 static int reprogram_opcode_on_the_fly(uint8_t opcode, unsigned int writecnt, unsigned int readcnt)
 {
 	uint8_t spi_type;
+	int i;
 
 	spi_type = lookup_spi_type(opcode);
 	if (spi_type > 3) {
@@ -501,11 +525,22 @@ static int reprogram_opcode_on_the_fly(uint8_t opcode, unsigned int writecnt, un
 		else // we have an invalid case
 			return SPI_INVALID_LENGTH;
 	}
-	int oppos = 2;	// use original JEDEC_BE_D8 offset
+	/* Replace the least recently used slot, so that alternating opcodes don't thrash a single one. */
+	int oppos = -1;
+	for (i = 0; i < 8; i++) {
+		if (opcode_is_pinned(curopcodes->opcode[i].opcode))
+			continue;
+		if (oppos < 0 || opcode_last_use[i] < opcode_last_use[oppos])
+			oppos = i;
+	}
+	if (oppos < 0)
+		return -1;
 	curopcodes->opcode[oppos].opcode = opcode;
 	curopcodes->opcode[oppos].spi_type = spi_type;
 	program_opcodes(curopcodes, 0);
 	oppos = find_opcode(curopcodes, opcode);
+	if (oppos >= 0)
+		note_opcode_use(oppos);
 	msg_pdbg2("on-the-fly OPCODE (0x%02X) re-programmed, op-pos=%d\n", opcode, oppos);
 	return oppos;
 }
@@ -737,16 +772,11 @@ static void ich_set_bbar(uint32_t min_addr)
  * may even crash.
  */
 static void ich_read_data(uint8_t *data, int len, int reg0_off)
- {
-	int i;
-	uint32_t temp32 = 0;
-
-	for (i = 0; i < len; i++) {
-		if ((i % 4) == 0)
-			temp32 = REGREAD32(reg0_off + i);
+{
+	if (len <= 0)
+		return;
 
-		data[i] = (temp32 >> ((i % 4) * 8)) & 0xff;
-	}
+	mmio_le_readn32(ich_spibar + reg0_off, data, len);
 }
 
 /* Fill len bytes from the data array into the fdata/spid registers.
@@ -756,24 +786,10 @@ static void ich_read_data(uint8_t *data, int len, int reg0_off)
  */
 static void ich_fill_data(const uint8_t *data, int len, int reg0_off)
 {
-	uint32_t temp32 = 0;
-	int i;
-
 	if (len <= 0)
 		return;
 
-	for (i = 0; i < len; i++) {
-		if ((i % 4) == 0)
-			temp32 = 0;
-
-		temp32 |= ((uint32_t) data[i]) << ((i % 4) * 8);
-
-		if ((i % 4) == 3) /* 32 bits are full, write them to regs. */
-			REGWRITE32(reg0_off + (i - (i % 4)), temp32);
-	}
-	i--;
-	if ((i % 4) != 3) /* Write remaining data to regs. */
-		REGWRITE32(reg0_off + (i - (i % 4)), temp32);
+	mmio_le_writen32(ich_spibar + reg0_off, data, len);
 }
 
 /* This function generates OPCODES from or programs OPCODES to ICH according to
@@ -1111,6 +1127,7 @@ static int ich_spi_send_command(struct flashctx *flash, unsigned int writecnt,
 		}
 	}
 
+	note_opcode_use(opcode_index);
 	opcode = &(curopcodes->opcode[opcode_index]);
 
 	/* The following valid writecnt/readcnt combinations exist:
@@ -1193,6 +1210,9 @@ static int ich_spi_send_command(struct flashctx *flash, unsigned int writecnt,
 	}
 
 	result = run_opcode(flash, *opcode, addr, count, data);
+	/* ICH8+ software sequencing polls the chip's WIP bit itself as part of an atomic cycle. */
+	flash->spi_wip_clear = !result && opcode->atomic && ich_generation != CHIPSET_ICH7 &&
+			       ich_generation != CHIPSET_TUNNEL_CREEK && ich_generation != CHIPSET_CENTERTON;
 	if (result) {
 		msg_pdbg("Running OPCODE 0x%02x failed ", opcode->opcode);
 		if ((opcode->spi_type == SPI_OPCODE_TYPE_WRITE_WITH_ADDRESS) ||
@@ -1403,26 +1423,106 @@ static int ich_hwseq_block_erase(struct flashctx *flash, unsigned int addr,
 	return 0;
 }
 
-static int ich_hwseq_read(struct flashctx *flash, uint8_t *buf,
-			  unsigned int addr, unsigned int len)
+/* Flash ranges the FREG/FRAP and PR settings don't let us read. */
+static struct {
+	uint32_t base;
+	uint32_t limit;	/* inclusive */
+} ich_read_locked[32];
+static unsigned int ich_num_read_locked = 0;
+/* Fill read-protected ranges with 0xff instead of failing plain reads. */
+static bool ich_skip_locked = false;
+
+static void ich_add_read_locked(uint32_t base, uint32_t limit)
+{
+	if (ich_num_read_locked >= ARRAY_SIZE(ich_read_locked))
+		return;
+	ich_read_locked[ich_num_read_locked].base = base;
+	ich_read_locked[ich_num_read_locked].limit = limit;
+	ich_num_read_locked++;
+}
+
+typedef int (*ich_readfn_t)(struct flashctx *, uint8_t *, unsigned int, unsigned int);
+
+/*
+ * Reads with `readfn` but keeps away from read-protected ranges, which would
+ * only produce a transaction error (or a timeout) for every single cycle.
+ */
+static int ich_read_permitted(struct flashctx *flash, uint8_t *buf, unsigned int addr,
+			      unsigned int len, const ich_readfn_t readfn)
+{
+	while (len) {
+		unsigned int chunk = len, i;
+		bool locked = false;
+
+		for (i = 0; i < ich_num_read_locked; i++) {
+			const uint32_t base = ich_read_locked[i].base, limit = ich_read_locked[i].limit;
+			if (base <= addr && addr <= limit) {
+				locked = true;
+				chunk = min(chunk, limit - addr + 1);
+			} else if (base > addr && base - addr < chunk) {
+				chunk = base - addr;
+			}
+		}
+
+		if (locked && !ich_skip_locked) {
+			msg_perr("Can't read 0x%06x-0x%06x, the range is read-protected. Use "
+				 "ich_spi_skip_locked=yes to read around it.\n", addr, addr + chunk - 1);
+			return -1;
+		}
+		/* Writes and verifies would take the filler for the real contents. */
+		if (locked && !flash->read_only_access) {
+			msg_perr("Can't read 0x%06x-0x%06x, the range is read-protected. Only plain "
+				 "reads can skip it.\n", addr, addr + chunk - 1);
+			return -1;
+		}
+		if (locked) {
+			msg_pwarn("Skipping read-protected range 0x%06x-0x%06x, filled with 0xff.\n",
+				  addr, addr + chunk - 1);
+			memset(buf, 0xff, chunk);
+		} else if (readfn(flash, buf, addr, chunk)) {
+			return 1;
+		}
+		addr += chunk;
+		buf += chunk;
+		len -= chunk;
+	}
+	return 0;
+}
+
+static int ich_hwseq_read_chunked(struct flashctx *flash, uint8_t *buf,
+				  unsigned int addr, unsigned int len);
+
+/*
+ * In software sequencing mode, reads may still be done by the hardware
+ * sequencer: It handles a whole 64-byte cycle with a single HSFC write
+ * instead of reprogramming the opcode, address and control registers of the
+ * software sequencer for every cycle. Everything else (status register,
+ * custom erase sizes, page programming) stays with the software sequencer.
+ */
+static bool ich_hybrid_read = false;
+
+static int ich_spi_read(struct flashctx *flash, uint8_t *buf, unsigned int addr, unsigned int len)
+{
+	if (ich_hybrid_read)
+		return ich_read_permitted(flash, buf, addr, len, ich_hwseq_read_chunked);
+	return ich_read_permitted(flash, buf, addr, len, default_spi_read);
+}
+
+/* Also used with the software sequencer, so don't look at flash->mst. */
+static int ich_hwseq_read_chunked(struct flashctx *flash, uint8_t *buf,
+				  unsigned int addr, unsigned int len)
 {
 	uint16_t hsfc;
 	uint16_t timeout = 100 * 60;
 	uint8_t block_len;
 
-	if (addr + len > flash->chip->total_size * 1024) {
-		msg_perr("Request to read from an inaccessible memory address "
-			 "(addr=0x%x, len=%d).\n", addr, len);
-		return -1;
-	}
-
 	msg_pdbg("Reading %d bytes starting at 0x%06x.\n", len, addr);
 	/* clear FDONE, FCERR, AEL by writing 1 to them (if they are set) */
 	REGWRITE16(ICH9_REG_HSFS, REGREAD16(ICH9_REG_HSFS));
 
 	while (len > 0) {
-		/* Obey programmer limit... */
-		block_len = min(len, flash->mst->opaque.max_data_read);
+		/* Obey the FDATA size... */
+		block_len = min(len, 64);
 		/* as well as flash chip page borders as demanded in the Intel datasheets. */
 		block_len = min(block_len, 256 - (addr & 0xFF));
 
@@ -1445,6 +1545,17 @@ static int ich_hwseq_read(struct flashctx *flash, uint8_t *buf,
 	return 0;
 }
 
+static int ich_hwseq_read(struct flashctx *flash, uint8_t *buf,
+			  unsigned int addr, unsigned int len)
+{
+	if (addr + len > flash->chip->total_size * 1024) {
+		msg_perr("Request to read from an inaccessible memory address "
+			 "(addr=0x%x, len=%d).\n", addr, len);
+		return -1;
+	}
+	return ich_read_permitted(flash, buf, addr, len, ich_hwseq_read_chunked);
+}
+
 static int ich_hwseq_write(struct flashctx *flash, const uint8_t *buf, unsigned int addr, unsigned int len)
 {
 	uint16_t hsfc;
@@ -1519,7 +1630,7 @@ static int ich_spi_send_multicommand(struct flashctx *flash,
 				 */
 				if (!ichspi_lock) {
 					oppos = reprogram_opcode_on_the_fly((cmds + 1)->writearr[0], (cmds + 1)->writecnt, (cmds + 1)->readcnt);
-					if (oppos == -1)
+					if (oppos < 0)
 						continue;
 					curopcodes->opcode[oppos].atomic = preoppos + 1;
 					continue;
@@ -1602,6 +1713,8 @@ static int ich9_handle_frap(uint32_t frap, int i)
 
 	msg_pwarn("FREG%i: Warning: %s region (0x%08x-0x%08x) is %s.\n", i,
 		  region_name, base, limit, access_names[rwperms]);
+	if (!(rwperms & 1))
+		ich_add_read_locked(base, limit);
 	return 1;
 }
 
@@ -1637,6 +1750,8 @@ static int ich9_handle_pr(const size_t reg_pr0, int i)
 	msg_pdbg("0x%02X: 0x%08x ", off, pr);
 	msg_pwarn("%sPR%u: Warning: 0x%08x-0x%08x is %s.\n", prefix, i, ICH_FREG_BASE(pr),
 		  ICH_FREG_LIMIT(pr), access_names[rwperms]);
+	if (!(rwperms & 1))
+		ich_add_read_locked(ICH_FREG_BASE(pr), ICH_FREG_LIMIT(pr));
 	return 1;
 }
 
@@ -1680,7 +1795,7 @@ static const struct spi_master spi_master_ich9 = {
 	.max_data_write = 64,
 	.command = ich_spi_send_command,
 	.multicommand = ich_spi_send_multicommand,
-	.read = default_spi_read,
+	.read = ich_spi_read,
 	.write_256 = default_spi_write_256,
 	.write_aai = default_spi_write_aai,
 };
@@ -1825,6 +1940,18 @@ int ich_init_spi(void *spibar, enum ich_chipset ich_gen)
 		}
 		free(arg);
 
+		ich_skip_locked = false;
+		arg = extract_programmer_param("ich_spi_skip_locked");
+		if (arg && !strcmp(arg, "yes")) {
+			ich_skip_locked = true;
+		} else if (arg) {
+			msg_perr("Unknown argument for ich_spi_skip_locked: \"%s\" (not \"yes\").\n", arg);
+			free(arg);
+			return ERROR_FATAL;
+		}
+		free(arg);
+		ich_num_read_locked = 0;
+
 		tmp2 = mmio_readw(ich_spibar + ICH9_REG_HSFS);
 		msg_pdbg("0x04: 0x%04x (HSFS)\n", tmp2);
 		prettyprint_ich9_reg_hsfs(tmp2);
@@ -1991,6 +2118,14 @@ int ich_init_spi(void *spibar, enum ich_chipset ich_gen)
 
 			register_opaque_master(&opaque_master_ich_hwseq);
 		} else {
+			/*
+			 * Hardware sequencing addresses the flash linear space,
+			 * which only matches the chip addresses with a valid
+			 * descriptor and a single chip (checked above).
+			 */
+			ich_hybrid_read = ich_spi_mode == ich_auto && desc_valid;
+			if (ich_hybrid_read)
+				msg_pdbg("Using hardware sequencing for reads.\n");
 			register_spi_master(&spi_master_ich9);
 		}
 		break;
@@ -225,7 +225,7 @@ int internal_init(void)
 	}
 	free(arg);
 
-	if (rget_io_perms())
+	if (rget_byte_io_perms())
 		return 1;
 
 	/* Default to Parallel/LPC/FWH flash devices. If a known host controller
@@ -30,6 +30,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "flash.h"
+#include "chipdrivers.h"
 #include "spi.h"
 #include "programmer.h"
 #include "hwaccess.h"
@@ -82,6 +83,8 @@ unsigned int shm_io_base;
 #endif
 unsigned char *ce_high, *ce_low;
 static int it85xx_scratch_rom_reenter = 0;
+/* Set once entering scratch ROM mode ran out of tries, so we don't retry for every command. */
+static int it85xx_scratch_rom_failed = 0;
 
 /* This function will poll the keyboard status register until either
  * an expected value shows up, or the timeout is reached.
@@ -114,9 +117,9 @@ void it85xx_enter_scratch_rom(void)
 {
 	int ret, tries;
 
-	msg_pdbg("%s():%d was called ...\n", __func__, __LINE__);
-	if (it85xx_scratch_rom_reenter > 0)
+	if (it85xx_scratch_rom_reenter > 0 || it85xx_scratch_rom_failed)
 		return;
+	msg_pdbg("%s():%d was called ...\n", __func__, __LINE__);
 
 #if 0
 	/* FIXME: this a workaround for the bug that SMBus signal would
@@ -163,6 +166,7 @@ void it85xx_enter_scratch_rom(void)
 		it85xx_scratch_rom_reenter++;
 		msg_pdbg("%s():%d * SUCCESS.\n", __func__, __LINE__);
 	} else {
+		it85xx_scratch_rom_failed = 1;
 		msg_perr("%s():%d * Max try reached.\n", __func__, __LINE__);
 	}
 }
@@ -175,6 +179,7 @@ void it85xx_exit_scratch_rom(void)
 	int tries;
 
 	msg_pdbg("%s():%d was called ...\n", __func__, __LINE__);
+	it85xx_scratch_rom_failed = 0;
 	if (it85xx_scratch_rom_reenter <= 0)
 		return;
 
@@ -278,6 +283,8 @@ static int it85xx_spi_send_command(struct flashctx *flash,
 				   unsigned int writecnt, unsigned int readcnt,
 				   const unsigned char *writearr,
 				   unsigned char *readarr);
+static int it85xx_spi_read(struct flashctx *flash, uint8_t *buf,
+			   unsigned int start, unsigned int len);
 
 static const struct spi_master spi_master_it85xx = {
 	.type		= SPI_CONTROLLER_IT85XX,
@@ -285,7 +292,7 @@ static const struct spi_master spi_master_it85xx = {
 	.max_data_write	= 64,
 	.command	= it85xx_spi_send_command,
 	.multicommand	= default_spi_send_multicommand,
-	.read		= default_spi_read,
+	.read		= it85xx_spi_read,
 	.write_256	= default_spi_write_256,
 	.write_aai	= default_spi_write_aai,
 };
@@ -374,4 +381,13 @@ static int it85xx_spi_send_command(struct flashctx *flash,
 	return 0;
 }
 
+/* CE# stays low while we keep reading, so a single READ command streams any amount of data. */
+#define IT85XX_MAX_READ	(64 * 1024)
+
+static int it85xx_spi_read(struct flashctx *flash, uint8_t *buf,
+			   unsigned int start, unsigned int len)
+{
+	return spi_read_chunked(flash, buf, start, len, IT85XX_MAX_READ);
+}
+
 #endif
@@ -19,6 +19,8 @@
  * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
  */
 
+#include <ctype.h>
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -49,6 +51,22 @@ const struct flashrom_layout *get_layout(const struct flashrom_flashctx *const f
 }
 
 #ifndef __LIBPAYLOAD__
+/* Parses a hexadecimal layout address, returns 0 on success. */
+static int parse_layout_addr(const char *str, chipoff_t *addr)
+{
+	char *endptr;
+	unsigned long val;
+
+	if (!isxdigit((unsigned char)*str))
+		return 1;
+	errno = 0;
+	val = strtoul(str, &endptr, 16);
+	if (errno || *endptr != '\0' || val > UINT32_MAX)
+		return 1;
+	*addr = val;
+	return 0;
+}
+
 int read_romlayout(const char *name)
 {
 	FILE *romlayout;
@@ -82,13 +100,13 @@ int read_romlayout(const char *name)
 #endif
 		tstr1 = strtok(tempstr, ":");
 		tstr2 = strtok(NULL, ":");
-		if (!tstr1 || !tstr2) {
+		if (!tstr1 || !tstr2 || strtok(NULL, ":") ||
+		    parse_layout_addr(tstr1, &layout.entries[layout.num_entries].start) ||
+		    parse_layout_addr(tstr2, &layout.entries[layout.num_entries].end)) {
 			msg_gerr("Error parsing layout file. Offending string: \"%s\"\n", tempstr);
 			(void)fclose(romlayout);
 			return 1;
 		}
-		layout.entries[layout.num_entries].start = strtol(tstr1, (char **)NULL, 16);
-		layout.entries[layout.num_entries].end = strtol(tstr2, (char **)NULL, 16);
 		layout.entries[layout.num_entries].included = 0;
 		layout.num_entries++;
 	}
@@ -144,7 +144,7 @@ int flashrom_programmer_init(struct flashrom_programmer **const flashprog,
 		list_programmers_linebreak(0, 80, 0);
 		return 1;
 	}
-	return programmer_init(prog, prog_param);
+	return programmer_init(flashprog, prog, prog_param);
 }
 
 /**
@@ -155,7 +155,7 @@ int flashrom_programmer_init(struct flashrom_programmer **const flashprog,
  */
 int flashrom_programmer_shutdown(struct flashrom_programmer *const flashprog)
 {
-	return programmer_shutdown();
+	return programmer_shutdown(flashprog);
 }
 
 /* TODO: flashrom_programmer_capabilities()? */
@@ -194,19 +194,19 @@ int flashrom_flash_probe(struct flashrom_flashctx **const flashctx,
 	int i, ret = 2;
 	struct flashrom_flashctx second_flashctx = { 0, };
 
-	chip_to_probe = chip_name; /* chip_to_probe is global in flashrom.c */
-
 	*flashctx = malloc(sizeof(**flashctx));
 	if (!*flashctx)
 		return 1;
 	memset(*flashctx, 0, sizeof(**flashctx));
+	(*flashctx)->chip_to_probe = chip_name;
+	second_flashctx.chip_to_probe = chip_name;
 
-	for (i = 0; i < registered_master_count; ++i) {
+	for (i = 0; i < flashprog->master_count; ++i) {
 		int flash_idx = -1;
-		if (!ret || (flash_idx = probe_flash(&registered_masters[i], 0, *flashctx, 0)) != -1) {
+		if (!ret || (flash_idx = probe_flash(&flashprog->masters[i], 0, *flashctx, 0)) != -1) {
 			ret = 0;
 			/* We found one chip, now check that there is no second match. */
-			if (probe_flash(&registered_masters[i], flash_idx + 1, &second_flashctx, 0) != -1) {
+			if (probe_flash(&flashprog->masters[i], flash_idx + 1, &second_flashctx, 0) != -1) {
 				ret = 3;
 				break;
 			}
@@ -0,0 +1,240 @@
+/*
+ * This file is part of the flashrom project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+/*
+ * Accesses the flash through the MTD layer of the Linux kernel. The kernel's
+ * SPI-NOR framework then takes care of the chip, so controller features like
+ * direct-mapped reads, DMA and quad I/O are used where spidev can only send
+ * generic commands.
+ */
+
+#if CONFIG_LINUX_MTD == 1
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <mtd/mtd-user.h>
+#include "flash.h"
+#include "programmer.h"
+
+static int fd = -1;
+static struct mtd_info_user mtd_info;
+
+static int linux_mtd_shutdown(void *data)
+{
+	if (fd != -1) {
+		close(fd);
+		fd = -1;
+	}
+	return 0;
+}
+
+static int linux_mtd_probe(struct flashctx *flash)
+{
+	struct block_eraser *eraser = &flash->chip->block_erasers[0];
+
+	msg_cdbg("MTD device reports %u kB in %u B erase blocks.\n",
+		 mtd_info.size / 1024, mtd_info.erasesize);
+	flash->chip->total_size = mtd_info.size / 1024;
+	flash->chip->tested = TEST_OK_PREW;
+	eraser->eraseblocks[0].size = mtd_info.erasesize;
+	eraser->eraseblocks[0].count = mtd_info.size / mtd_info.erasesize;
+	return 1;
+}
+
+static int linux_mtd_read(struct flashctx *flash, uint8_t *buf, unsigned int start, unsigned int len)
+{
+	while (len) {
+		const ssize_t ret = pread(fd, buf, len, start);
+		if (ret < 0 && errno == EINTR)
+			continue;
+		if (ret <= 0) {
+			msg_perr("%s: Reading %u bytes at 0x%06x failed: %s\n", __func__, len, start,
+				 ret ? strerror(errno) : "unexpected end of device");
+			return 1;
+		}
+		buf += ret;
+		start += ret;
+		len -= ret;
+	}
+	return 0;
+}
+
+/*
+ * Fails if the device is read-only or if any erase block in the given range
+ * is locked by the kernel driver (see MEMLOCK).
+ */
+static int linux_mtd_check_writable(unsigned int start, unsigned int len)
+{
+	struct erase_info_user ei;
+	const uint32_t end = start + len;
+
+	if (!(mtd_info.flags & MTD_WRITEABLE)) {
+		msg_perr("The MTD device is read-only.\n");
+		return 1;
+	}
+
+	ei.length = mtd_info.erasesize;
+	for (ei.start = start - start % mtd_info.erasesize; ei.start < end; ei.start += ei.length) {
+		const int ret = ioctl(fd, MEMISLOCKED, &ei);
+		if (ret < 0) {
+			/* Not every driver implements locking. */
+			if (errno == EOPNOTSUPP || errno == ENOTTY)
+				return 0;
+			msg_perr("%s: Checking the lock state at 0x%06x failed: %s\n",
+				 __func__, ei.start, strerror(errno));
+			return 1;
+		}
+		if (ret > 0) {
+			msg_perr("The erase block at 0x%06x is locked. Unlock it first, "
+				 "e.g. with flash_unlock from mtd-utils.\n", ei.start);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+static int linux_mtd_write(struct flashctx *flash, const uint8_t *buf, unsigned int start, unsigned int len)
+{
+	if (linux_mtd_check_writable(start, len))
+		return 1;
+
+	while (len) {
+		const ssize_t ret = pwrite(fd, buf, len, start);
+		if (ret < 0 && errno == EINTR)
+			continue;
+		if (ret <= 0) {
+			msg_perr("%s: Writing %u bytes at 0x%06x failed: %s\n", __func__, len, start,
+				 ret ? strerror(errno) : "unexpected end of device");
+			return 1;
+		}
+		buf += ret;
+		start += ret;
+		len -= ret;
+	}
+	return 0;
+}
+
+static int linux_mtd_erase(struct flashctx *flash, unsigned int blockaddr, unsigned int blocklen)
+{
+	struct erase_info_user ei = {
+		.start	= blockaddr,
+		.length	= blocklen,
+	};
+
+	if (blockaddr % mtd_info.erasesize || blocklen % mtd_info.erasesize) {
+		msg_perr("%s: 0x%x bytes at 0x%06x are not aligned to the erase block size.\n",
+			 __func__, blocklen, blockaddr);
+		return 1;
+	}
+	if (linux_mtd_check_writable(blockaddr, blocklen))
+		return 1;
+
+	/* Devices without erase (e.g. some RAM backed ones) take any data, so "erase" by writing 0xff. */
+	if (mtd_info.flags & MTD_NO_ERASE) {
+		uint8_t *ff = malloc(blocklen);
+		int ret;
+
+		if (!ff) {
+			msg_perr("Out of memory!\n");
+			return 1;
+		}
+		memset(ff, 0xff, blocklen);
+		ret = linux_mtd_write(flash, ff, blockaddr, blocklen);
+		free(ff);
+		return ret;
+	}
+
+	if (ioctl(fd, MEMERASE, &ei) < 0) {
+		msg_perr("%s: Erasing 0x%x bytes at 0x%06x failed: %s\n",
+			 __func__, blocklen, blockaddr, strerror(errno));
+		return 1;
+	}
+	return 0;
+}
+
+static const struct opaque_master opaque_master_linux_mtd = {
+	.max_data_read	= MAX_DATA_UNSPECIFIED,
+	.max_data_write	= MAX_DATA_UNSPECIFIED,
+	.probe		= linux_mtd_probe,
+	.read		= linux_mtd_read,
+	.write		= linux_mtd_write,
+	.erase		= linux_mtd_erase,
+};
+
+int linux_mtd_init(void)
+{
+	char *param, *endp;
+	char dev[32];
+	unsigned long dev_num = 0;
+	int regions;
+
+	param = extract_programmer_param("dev");
+	if (param) {
+		errno = 0;
+		dev_num = strtoul(param, &endp, 10);
+		if (!strlen(param) || *endp != '\0' || errno || dev_num > 0xffff) {
+			msg_perr("Invalid MTD device number \"%s\". Use flashrom -p linux_mtd:dev=N\n", param);
+			free(param);
+			return 1;
+		}
+	}
+	free(param);
+
+	snprintf(dev, sizeof(dev), "/dev/mtd%lu", dev_num);
+	msg_pdbg("Using device %s\n", dev);
+	fd = open(dev, O_RDWR);
+	/* Read-only partitions can still be read. */
+	if (fd == -1 && (errno == EACCES || errno == EROFS))
+		fd = open(dev, O_RDONLY);
+	if (fd == -1) {
+		msg_perr("%s: failed to open %s: %s\n", __func__, dev, strerror(errno));
+		return 1;
+	}
+
+	if (register_shutdown(linux_mtd_shutdown, NULL))
+		return 1;
+	/* We rely on the shutdown function for cleanup from here on. */
+
+	if (ioctl(fd, MEMGETINFO, &mtd_info) < 0) {
+		msg_perr("%s: MEMGETINFO failed on %s: %s\n", __func__, dev, strerror(errno));
+		return 1;
+	}
+
+	/* NAND would need bad block and ECC handling, which flashrom's write logic knows nothing about. */
+	if (mtd_info.type != MTD_NORFLASH && mtd_info.type != MTD_RAM) {
+		msg_perr("%s is not a NOR flash (MTD type %u), which is all that is supported.\n",
+			 dev, mtd_info.type);
+		return 1;
+	}
+	if (!mtd_info.erasesize || mtd_info.size % mtd_info.erasesize) {
+		msg_perr("%s: Size 0x%x is not a multiple of the erase block size 0x%x.\n",
+			 dev, mtd_info.size, mtd_info.erasesize);
+		return 1;
+	}
+
+	/* Non-uniform erase regions can't be described by a single eraser. */
+	if (ioctl(fd, MEMGETREGIONCOUNT, &regions) == 0 && regions > 1) {
+		msg_perr("%s has %d erase regions of different size, which is not supported.\n",
+			 dev, regions);
+		return 1;
+	}
+
+	return register_opaque_master(&opaque_master_linux_mtd);
+}
+
+#endif // CONFIG_LINUX_MTD == 1
@@ -55,6 +55,20 @@ static int linux_spi_read(struct flashctx *flash, uint8_t *buf,
 static int linux_spi_write_256(struct flashctx *flash, const uint8_t *buf,
 			       unsigned int start, unsigned int len);
 
+/* Candidate clocks for spispeed=auto in kHz, slowest first. */
+static const uint32_t autotune_khz[] = { 1000, 2000, 4000, 8000, 12000, 16000, 20000, 25000, 33000, 40000, 50000 };
+
+static int linux_spi_autotune_set_speed(unsigned int idx)
+{
+	uint32_t speed_hz = autotune_khz[idx] * 1000;
+
+	if (ioctl(fd, SPI_IOC_WR_MAX_SPEED_HZ, &speed_hz) == -1) {
+		msg_pdbg("%s: failed to set speed to %d Hz: %s\n", __func__, speed_hz, strerror(errno));
+		return 1;
+	}
+	return 0;
+}
+
 static const struct spi_master spi_master_linux = {
 	.type		= SPI_CONTROLLER_LINUX,
 	.features	= SPI_MASTER_4BA,
@@ -71,13 +85,16 @@ int linux_spi_init(void)
 {
 	char *p, *endp, *dev;
 	uint32_t speed_hz = 0;
+	bool autotune = false;
 	/* FIXME: make the following configurable by CLI options. */
 	/* SPI mode 0 (beware this also includes: MSB first, CS active low and others */
 	const uint8_t mode = SPI_MODE_0;
 	const uint8_t bits = 8;
 
 	p = extract_programmer_param("spispeed");
-	if (p && strlen(p)) {
+	if (p && !strcmp(p, "auto")) {
+		autotune = true;
+	} else if (p && strlen(p)) {
 		speed_hz = (uint32_t)strtoul(p, &endp, 10) * 1000;
 		if (p == endp) {
 			msg_perr("%s: invalid clock: %s kHz\n", __func__, p);
@@ -175,6 +192,16 @@ out:
 	}
 
 	msg_pdbg("%s: max_kernel_buf_size: %zu\n", __func__, max_kernel_buf_size);
+
+	if (autotune) {
+		const int idx = spi_autotune_speed(&spi_master_linux, ARRAY_SIZE(autotune_khz),
+						   linux_spi_autotune_set_speed);
+		if (idx < 0)
+			return 1;
+		msg_pinfo("Using %d kHz clock, use spispeed=%d to skip autotuning next time.\n",
+			  autotune_khz[idx], autotune_khz[idx]);
+	}
+
 	register_spi_master(&spi_master_linux);
 	return 0;
 }
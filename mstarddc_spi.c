@@ -47,6 +47,13 @@ static int mstarddc_doreset = 1;
 #define MSTARDDC_SPI_END	0x12
 #define MSTARDDC_SPI_RESET	0x24
 
+/* Opcode, up to four address bytes and one chunk of data. */
+#define MSTARDDC_MAX_WRITE	(5 + 256)
+#define MSTARDDC_MAX_READ	256
+
+/* The write buffer is kept around, it holds the write command byte plus the SPI bytes. */
+static uint8_t mstarddc_cmdbuf[1 + MSTARDDC_MAX_WRITE];
+
 /* Returns 0 upon success, a negative number upon errors. */
 static int mstarddc_spi_shutdown(void *data)
 {
@@ -156,21 +163,25 @@ out:
 	return ret;
 }
 
-/* Returns 0 upon success, a negative number upon errors. */
+/*
+ * The write, the read and the end command are separate I2C transfers, each
+ * one ends with a STOP condition. The ISP protocol may rely on those to
+ * frame CS#, so they are not merged into one I2C_RDWR request.
+ * Returns 0 upon success, a negative number upon errors.
+ */
 static int mstarddc_spi_send_command(struct flashctx *flash,
 				     unsigned int writecnt,
 				     unsigned int readcnt,
 				     const unsigned char *writearr,
 				     unsigned char *readarr)
 {
+	uint8_t *const cmd = mstarddc_cmdbuf;
 	int ret = 0;
-	uint8_t *cmd = malloc((writecnt + 1) * sizeof(uint8_t));
-	if (cmd == NULL) {
-		msg_perr("Error allocating memory: errno %d.\n", errno);
-		ret = -1;
-	}
 
-	if (!ret && writecnt) {
+	if (writecnt > MSTARDDC_MAX_WRITE || readcnt > MSTARDDC_MAX_READ)
+		return SPI_INVALID_LENGTH;
+
+	if (writecnt) {
 		cmd[0] = MSTARDDC_SPI_WRITE;
 		memcpy(cmd + 1, writearr, writecnt);
 		if (write(mstarddc_fd, cmd, writecnt + 1) < 0) {
@@ -217,15 +228,12 @@ static int mstarddc_spi_send_command(struct flashctx *flash,
 	if (ret != 0)
 		mstarddc_doreset = 0;
 
-	if (cmd)
-		free(cmd);
-
 	return ret;
 }
 
 static const struct spi_master spi_master_mstarddc = {
 	.type = SPI_CONTROLLER_MSTARDDC,
-	.max_data_read = 256,
+	.max_data_read = MSTARDDC_MAX_READ,
 	.max_data_write = 256,
 	.command = mstarddc_spi_send_command,
 	.multicommand = default_spi_send_multicommand,
@@ -67,7 +67,7 @@ int nicintel_init(void)
 	/* Needed only for PCI accesses on some platforms.
 	 * FIXME: Refactor that into get_mem_perms/rget_io_perms/get_pci_perms?
 	 */
-	if (rget_io_perms())
+	if (rget_byte_io_perms())
 		return 1;
 
 	/* FIXME: BAR2 is not available if the device uses the CardBus function. */
@@ -455,7 +455,7 @@ static int nicintel_ee_shutdown(void *eecp)
 
 int nicintel_ee_init(void)
 {
-	if (rget_io_perms())
+	if (rget_byte_io_perms())
 		return 1;
 
 	struct pci_dev *dev = pcidev_init(nics_intel_ee, PCI_BASE_ADDRESS_0);
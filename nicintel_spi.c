@@ -250,7 +250,7 @@ int nicintel_spi_init(void)
 {
 	struct pci_dev *dev = NULL;
 
-	if (rget_io_perms())
+	if (rget_byte_io_perms())
 		return 1;
 
 	dev = pcidev_init(nics_intel_spi, PCI_BASE_ADDRESS_0);
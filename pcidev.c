@@ -259,61 +259,52 @@ enum pci_write_type {
 	pci_write_type_long,
 };
 
-struct undo_pci_write_data {
-	struct pci_dev *dev;
-	int reg;
-	enum pci_write_type type;
-	union {
-		uint8_t bytedata;
-		uint16_t worddata;
-		uint32_t longdata;
-	};
-};
+/* Undo log key: PCI location and register offset, so that writes through
+ * different struct pci_dev copies of the same device are coalesced. */
+static uint64_t undo_pci_addr(const struct pci_dev *dev, int reg)
+{
+	return ((uint64_t)dev->domain << 32) | ((uint64_t)dev->bus << 24) |
+	       ((uint64_t)dev->dev << 19) | ((uint64_t)dev->func << 16) | (reg & 0xffff);
+}
 
-int undo_pci_write(void *p)
+static int undo_pci_write(const struct undo_entry *entry)
 {
-	struct undo_pci_write_data *data = p;
-	if (pacc == NULL || data->dev == NULL) {
+	struct pci_dev *const dev = entry->priv;
+	const int reg = entry->addr & 0xffff;
+
+	if (pacc == NULL || dev == NULL) {
 		msg_perr("%s: Tried to undo PCI writes without a valid PCI %s!\n"
 			"Please report a bug at flashrom@flashrom.org\n",
-			__func__, data->dev == NULL ? "device" : "context");
+			__func__, dev == NULL ? "device" : "context");
 		return 1;
 	}
 	msg_pdbg("Restoring PCI config space for %02x:%02x:%01x reg 0x%02x\n",
-		 data->dev->bus, data->dev->dev, data->dev->func, data->reg);
-	switch (data->type) {
+		 dev->bus, dev->dev, dev->func, reg);
+	switch (entry->type) {
 	case pci_write_type_byte:
-		pci_write_byte(data->dev, data->reg, data->bytedata);
+		pci_write_byte(dev, reg, entry->val);
 		break;
 	case pci_write_type_word:
-		pci_write_word(data->dev, data->reg, data->worddata);
+		pci_write_word(dev, reg, entry->val);
 		break;
 	case pci_write_type_long:
-		pci_write_long(data->dev, data->reg, data->longdata);
+		pci_write_long(dev, reg, entry->val);
 		break;
 	}
-	/* p was allocated in register_undo_pci_write. */
-	free(p);
 	return 0;
 }
 
 #define register_undo_pci_write(a, b, c) 				\
 {									\
-	struct undo_pci_write_data *undo_pci_write_data;		\
-	undo_pci_write_data = malloc(sizeof(struct undo_pci_write_data)); \
-	if (!undo_pci_write_data) {					\
-		msg_gerr("Out of memory!\n");				\
-		exit(1);						\
-	}								\
-	if (pacc)							\
-		undo_pci_write_data->dev = pci_get_dev(pacc,		\
+	struct undo_entry *undo_entry;					\
+	undo_entry = register_undo(undo_pci_write, undo_pci_addr(a, b),	\
+				   pci_write_type_##c);			\
+	if (undo_entry) {						\
+		if (pacc)						\
+			undo_entry->priv = pci_get_dev(pacc,		\
 				a->domain, a->bus, a->dev, a->func);	\
-	else								\
-		undo_pci_write_data->dev =  NULL;			\
-	undo_pci_write_data->reg = b;					\
-	undo_pci_write_data->type = pci_write_type_##c;			\
-	undo_pci_write_data->c##data = pci_read_##c(dev, reg);		\
-	register_shutdown(undo_pci_write, undo_pci_write_data);		\
+		undo_entry->val = pci_read_##c(a, b);			\
+	}								\
 }
 
 #define register_undo_pci_write_byte(a, b) register_undo_pci_write(a, b, byte)
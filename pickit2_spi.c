@@ -84,6 +84,7 @@ static usb_dev_handle *pickit2_handle;
 #define SCR_SPI_READ_BUF        0xC5
 #define SCR_SPI_WRITE_BUF       0xC6
 #define SCR_SET_AUX             0xCF
+#define SCR_DELAY_SHORT         0xE7
 #define SCR_LOOP                0xE9
 #define SCR_SET_ICSP_CLK_PERIOD 0xEA
 #define SCR_SET_PINS            0xF3
@@ -215,10 +216,29 @@ static int pickit2_set_spi_speed(unsigned int spispeed_idx)
 	return 0;
 }
 
+/* SCR_DELAY_SHORT waits for multiples of 21.3 us. */
+#define DELAY_SHORT_NS		21333
+/* Delay for the script engine to do before the next command, in SCR_DELAY_SHORT units. */
+static unsigned int stored_delay_units = 0;
+
+/*
+ * Delays are done by the script engine at the start of the next command instead
+ * of on the host, which saves the USB round trip of an extra sleep in between.
+ */
+void pickit2_spi_delay(unsigned int usecs)
+{
+	const unsigned long long units = ((unsigned long long)usecs * 1000 + DELAY_SHORT_NS - 1) / DELAY_SHORT_NS;
+
+	if (stored_delay_units + units > 255) {
+		internal_delay(usecs);
+		return;
+	}
+	stored_delay_units += units;
+}
+
 static int pickit2_spi_send_command(struct flashctx *flash, unsigned int writecnt, unsigned int readcnt,
 				     const unsigned char *writearr, unsigned char *readarr)
 {
-
 	/* Maximum number of bytes per transaction (including command overhead) is 64. Lets play it safe
 	 * and always assume the worst case scenario of 20 bytes command overhead.
 	 */
@@ -228,6 +248,11 @@ static int pickit2_spi_send_command(struct flashctx *flash, unsigned int writecn
 		return 1;
 	}
 
+	/* The script delay needs two more bytes, do the delay on the host if the packet is full. */
+	const bool script_delay = stored_delay_units && writecnt + readcnt + 22 <= CMD_LENGTH;
+	if (stored_delay_units && !script_delay)
+		internal_delay((stored_delay_units * DELAY_SHORT_NS + 999) / 1000);
+
 	uint8_t buf[CMD_LENGTH] = {CMD_DOWNLOAD_DATA, writecnt};
 	int i = 2;
 	for (; i < writecnt + 2; i++) {
@@ -244,7 +269,14 @@ static int pickit2_spi_send_command(struct flashctx *flash, unsigned int writecn
 		buf[i++] = 10;
 	else
 		buf[i++] = 13;
-		
+
+	if (script_delay) {
+		buf[i - 1] += 2;
+		buf[i++] = SCR_DELAY_SHORT;
+		buf[i++] = stored_delay_units;
+	}
+	stored_delay_units = 0;
+
 	/* Assert CS# */
 	buf[i++] = SCR_VPP_OFF;
 	buf[i++] = SCR_MCLR_GND_ON;
@@ -402,6 +434,8 @@ int pickit2_spi_init(void)
 {
 	unsigned int usedevice = 0; // FIXME: Allow selecting one of multiple devices
 
+	stored_delay_units = 0;
+
 	uint8_t buf[CMD_LENGTH] = {
 		CMD_EXEC_SCRIPT,
 		10,			/* Script length */
@@ -20,6 +20,9 @@
  * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
  */
 
+#include <errno.h>
+#include <stdarg.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
@@ -508,6 +511,220 @@ int print_supported(void)
 	return 0;
 }
 
+/* Growing output buffer for the machine-readable list, written out with a single fwrite(). */
+struct json_buf {
+	char *data;
+	size_t len;
+	size_t size;
+	bool oom;
+};
+
+static void json_append(struct json_buf *const b, const char *const fmt, ...)
+{
+	va_list ap;
+
+	if (b->oom)
+		return;
+	while (1) {
+		va_start(ap, fmt);
+		const int n = vsnprintf(b->data + b->len, b->size - b->len, fmt, ap);
+		va_end(ap);
+		if (n < 0) {
+			b->oom = true;
+			return;
+		}
+		if ((size_t)n < b->size - b->len) {
+			b->len += n;
+			return;
+		}
+		const size_t size = max(b->size * 2, b->len + n + 1);
+		char *const data = realloc(b->data, size);
+		if (!data) {
+			b->oom = true;
+			return;
+		}
+		b->data = data;
+		b->size = size;
+	}
+}
+
+/* Appends `str` as a quoted JSON string. */
+static void json_string(struct json_buf *const b, const char *str)
+{
+	json_append(b, "\"");
+	for (; str && *str; str++) {
+		const unsigned char c = *str;
+		if (c == '"' || c == '\\')
+			json_append(b, "\\%c", c);
+		else if (c < 0x20)
+			json_append(b, "\\u%04x", c);
+		else
+			json_append(b, "%c", c);
+	}
+	json_append(b, "\"");
+}
+
+static void json_field(struct json_buf *const b, const char *const key, const char *const value)
+{
+	json_string(b, key);
+	json_append(b, ": ");
+	json_string(b, value);
+}
+
+static void json_devs(struct json_buf *const b, const struct dev_entry *const devs)
+{
+	unsigned int i;
+	char id[10];
+
+	json_append(b, "[");
+	for (i = 0; devs[i].vendor_name != NULL; i++) {
+		snprintf(id, sizeof(id), "%04x:%04x", devs[i].vendor_id, devs[i].device_id);
+		json_append(b, "%s\n\t\t\t\t{ ", i ? "," : "");
+		json_field(b, "vendor", devs[i].vendor_name);
+		json_append(b, ", ");
+		json_field(b, "device", devs[i].device_name);
+		json_append(b, ", ");
+		json_field(b, "id", id);
+		json_append(b, ", ");
+		json_field(b, "status", test_state_to_text(devs[i].status));
+		json_append(b, " }");
+	}
+	json_append(b, "%s]", i ? "\n\t\t\t" : "");
+}
+
+#if CONFIG_INTERNAL == 1
+static void json_boards(struct json_buf *const b, const struct board_info *boards,
+			const char *const type, bool *const first)
+{
+	for (; boards->vendor != NULL; boards++) {
+		json_append(b, "%s\n\t\t{ ", *first ? "" : ",");
+		*first = false;
+		json_field(b, "vendor", boards->vendor);
+		json_append(b, ", ");
+		json_field(b, "name", boards->name);
+		json_append(b, ", ");
+		json_field(b, "type", type);
+		json_append(b, ", ");
+		json_field(b, "status", test_state_to_text(boards->working));
+		json_append(b, " }");
+	}
+}
+#endif
+
+/*
+ * Writes chips, chipsets, boards and programmers as JSON to `filename`.
+ * The whole document is assembled in memory first and written at once.
+ */
+int print_supported_json(const char *const filename)
+{
+	struct json_buf b = { 0 };
+	const struct flashchip *chip;
+	unsigned int i;
+	bool first = true;
+
+	json_append(&b, "{\n\t");
+	json_field(&b, "version", flashrom_version);
+	json_append(&b, ",\n\t\"chips\": [");
+	for (chip = flashchips; chip->name != NULL; chip++) {
+		/* Ignore generic entries. */
+		if (!strncmp(chip->vendor, "Unknown", 7) ||
+		    !strncmp(chip->vendor, "Programmer", 10) ||
+		    !strncmp(chip->name, "unknown", 7))
+			continue;
+		char *const buses = flashbuses_to_text(chip->bustype);
+		json_append(&b, "%s\n\t\t{ ", first ? "" : ",");
+		first = false;
+		json_field(&b, "vendor", chip->vendor);
+		json_append(&b, ", ");
+		json_field(&b, "name", chip->name);
+		json_append(&b, ", \"size_kb\": %u, ", chip->total_size);
+		json_field(&b, "bus", buses);
+		json_append(&b, ", \"voltage_mv\": [%u, %u], \"tested\": { ",
+			    chip->voltage.min, chip->voltage.max);
+		json_field(&b, "probe", test_state_to_text(chip->tested.probe));
+		json_append(&b, ", ");
+		json_field(&b, "read", test_state_to_text(chip->tested.read));
+		json_append(&b, ", ");
+		json_field(&b, "erase", test_state_to_text(chip->tested.erase));
+		json_append(&b, ", ");
+		json_field(&b, "write", test_state_to_text(chip->tested.write));
+		json_append(&b, " } }");
+		free(buses);
+	}
+	json_append(&b, "\n\t],\n\t\"chipsets\": [");
+#if CONFIG_INTERNAL == 1
+	const struct penable *c;
+	for (c = chipset_enables; c->vendor_name != NULL; c++) {
+		char id[10];
+		snprintf(id, sizeof(id), "%04x:%04x", c->vendor_id, c->device_id);
+		json_append(&b, "%s\n\t\t{ ", c == chipset_enables ? "" : ",");
+		json_field(&b, "vendor", c->vendor_name);
+		json_append(&b, ", ");
+		json_field(&b, "name", c->device_name);
+		json_append(&b, ", ");
+		json_field(&b, "id", id);
+		json_append(&b, ", ");
+		json_field(&b, "status", test_state_to_text(c->status));
+		json_append(&b, " }");
+	}
+	json_append(&b, "\n\t");
+#endif
+	json_append(&b, "],\n\t\"boards\": [");
+#if CONFIG_INTERNAL == 1
+	first = true;
+	json_boards(&b, boards_known, "mainboard", &first);
+	json_boards(&b, laptops_known, "laptop", &first);
+	json_append(&b, "\n\t");
+#endif
+	json_append(&b, "],\n\t\"programmers\": [");
+	for (i = 0; i < PROGRAMMER_INVALID; i++) {
+		const struct programmer_entry *const prog = &programmer_table[i];
+		json_append(&b, "%s\n\t\t{ ", i ? "," : "");
+		json_field(&b, "name", prog->name);
+		json_append(&b, ", ");
+		switch (prog->type) {
+		case USB:
+		case PCI:
+			json_field(&b, "type", prog->type == USB ? "USB" : "PCI");
+			json_append(&b, ", \"devices\": ");
+			json_devs(&b, prog->devs.dev);
+			break;
+		case OTHER:
+		default:
+			json_field(&b, "type", "other");
+			json_append(&b, ", ");
+			json_field(&b, "note", prog->devs.note);
+			break;
+		}
+		json_append(&b, " }");
+	}
+	json_append(&b, "\n\t]\n}\n");
+
+	if (b.oom) {
+		msg_gerr("Out of memory!\n");
+		free(b.data);
+		return 1;
+	}
+
+	int ret = 0;
+	FILE *const f = fopen(filename, "wb");
+	if (!f) {
+		msg_gerr("Error: opening file \"%s\" failed: %s\n", filename, strerror(errno));
+		free(b.data);
+		return 1;
+	}
+	if (fwrite(b.data, 1, b.len, f) != b.len) {
+		msg_gerr("Error: writing file \"%s\" failed: %s\n", filename, strerror(errno));
+		ret = 1;
+	}
+	if (fclose(f)) {
+		msg_gerr("Error: closing file \"%s\" failed: %s\n", filename, strerror(errno));
+		ret = 1;
+	}
+	free(b.data);
+	return ret;
+}
+
 #if CONFIG_INTERNAL == 1
 
 #ifdef CONFIG_PRINT_WIKI
@@ -101,6 +101,9 @@ enum programmer {
 #if CONFIG_LINUX_SPI == 1
 	PROGRAMMER_LINUX_SPI,
 #endif
+#if CONFIG_LINUX_MTD == 1
+	PROGRAMMER_LINUX_MTD,
+#endif
 #if CONFIG_USBBLASTER_SPI == 1
 	PROGRAMMER_USBBLASTER_SPI,
 #endif
@@ -148,8 +151,8 @@ struct programmer_entry {
 
 extern const struct programmer_entry programmer_table[];
 
-int programmer_init(enum programmer prog, const char *param);
-int programmer_shutdown(void);
+int programmer_init(struct flashrom_programmer **flashprog, enum programmer prog, const char *param);
+int programmer_shutdown(struct flashrom_programmer *flashprog);
 
 enum bitbang_spi_master_type {
 	BITBANG_SPI_INVALID	= 0, /* This must always be the first entry. */
@@ -343,6 +346,7 @@ struct pci_dev *pci_card_find(uint16_t vendor, uint16_t device,
 			      uint16_t card_vendor, uint16_t card_device);
 #endif
 int rget_io_perms(void);
+int rget_byte_io_perms(void);
 #if CONFIG_INTERNAL == 1
 extern int is_laptop;
 extern int laptop_ok;
@@ -368,6 +372,8 @@ void mmio_le_writel(uint32_t val, void *addr);
 uint8_t mmio_le_readb(const void *addr);
 uint16_t mmio_le_readw(const void *addr);
 uint32_t mmio_le_readl(const void *addr);
+void mmio_le_readn32(const void *addr, uint8_t *buf, size_t len);
+void mmio_le_writen32(void *addr, const uint8_t *buf, size_t len);
 #define pci_mmio_writeb mmio_le_writeb
 #define pci_mmio_writew mmio_le_writew
 #define pci_mmio_writel mmio_le_writel
@@ -489,6 +495,7 @@ extern const struct dev_entry devs_it8212[];
 /* ft2232_spi.c */
 #if CONFIG_FT2232_SPI == 1
 int ft2232_spi_init(void);
+void ft2232_spi_delay(unsigned int usecs);
 extern const struct dev_entry devs_ft2232spi[];
 #endif
 
@@ -506,6 +513,7 @@ int mstarddc_spi_init(void);
 /* pickit2_spi.c */
 #if CONFIG_PICKIT2_SPI == 1
 int pickit2_spi_init(void);
+void pickit2_spi_delay(unsigned int usecs);
 extern const struct dev_entry devs_pickit2_spi[];
 #endif
 
@@ -532,6 +540,11 @@ int buspirate_spi_init(void);
 int linux_spi_init(void);
 #endif
 
+/* linux_mtd.c */
+#if CONFIG_LINUX_MTD == 1
+int linux_mtd_init(void);
+#endif
+
 /* dediprog.c */
 #if CONFIG_DEDIPROG == 1
 int dediprog_init(void);
@@ -615,11 +628,27 @@ enum spi_controller {
 
 #define SPI_MASTER_4BA			(1U << 0)  /**< Can handle 4-byte addresses */
 
+/* Default number of reads kept in flight by masters with an asynchronous read interface. */
+#define SPI_READ_QUEUE_DEPTH 8
+
+/*
+ * A read request for the asynchronous read interface of a SPI master.
+ * The master sends `writearr` (opcode and address) and stores `readcnt`
+ * bytes to `readarr`. Requests complete in the order they were submitted.
+ */
+struct spi_read_request {
+	unsigned int writecnt;
+	unsigned int readcnt;
+	unsigned char writearr[5]; /* opcode and up to 4 address bytes */
+	unsigned char *readarr;
+};
+
 struct spi_master {
 	enum spi_controller type;
 	uint32_t features;
 	unsigned int max_data_read; // (Ideally,) maximum data read size in one go (excluding opcode+address).
 	unsigned int max_data_write; // (Ideally,) maximum data write size in one go (excluding opcode+address).
+	unsigned int write_cmd_cost; // Approximate cost of one more write command in bytes transferred, 0 for default.
 	int (*command)(struct flashctx *flash, unsigned int writecnt, unsigned int readcnt,
 		   const unsigned char *writearr, unsigned char *readarr);
 	int (*multicommand)(struct flashctx *flash, struct spi_command *cmds);
@@ -628,6 +657,16 @@ struct spi_master {
 	int (*read)(struct flashctx *flash, uint8_t *buf, unsigned int start, unsigned int len);
 	int (*write_256)(struct flashctx *flash, const uint8_t *buf, unsigned int start, unsigned int len);
 	int (*write_aai)(struct flashctx *flash, const uint8_t *buf, unsigned int start, unsigned int len);
+
+	/*
+	 * Optional asynchronous read interface: read_submit() queues a request
+	 * without waiting for its data, read_complete() waits for the oldest
+	 * queued request. At most max_reads_queued (or SPI_READ_QUEUE_DEPTH if
+	 * zero) requests are in flight, no other command is sent in between.
+	 */
+	unsigned int max_reads_queued;
+	int (*read_submit)(struct flashctx *flash, struct spi_read_request *req);
+	int (*read_complete)(struct flashctx *flash, struct spi_read_request *req);
 	const void *data;
 };
 
@@ -637,6 +676,7 @@ int default_spi_send_multicommand(struct flashctx *flash, struct spi_command *cm
 int default_spi_read(struct flashctx *flash, uint8_t *buf, unsigned int start, unsigned int len);
 int default_spi_write_256(struct flashctx *flash, const uint8_t *buf, unsigned int start, unsigned int len);
 int default_spi_write_aai(struct flashctx *flash, const uint8_t *buf, unsigned int start, unsigned int len);
+int spi_autotune_speed(const struct spi_master *mst, unsigned int count, int (*set_speed)(unsigned int idx));
 int register_spi_master(const struct spi_master *mst);
 
 /* The following enum is needed by ich_descriptor_tool and ich* code as well as in chipset_enable.c. */
@@ -736,10 +776,18 @@ struct registered_master {
 		struct opaque_master opaque;
 	};
 };
-extern struct registered_master registered_masters[];
-extern int registered_master_count;
 int register_master(const struct registered_master *mst);
 
+/* The limit of 4 is totally arbitrary. */
+#define MASTERS_MAX 4
+/* An initialized programmer. Its driver registers the masters during programmer_init(). */
+struct flashrom_programmer {
+	/* Parameters not yet extracted by the driver. */
+	const char *param;
+	struct registered_master masters[MASTERS_MAX];
+	int master_count;
+};
+
 /* serprog.c */
 #if CONFIG_SERPROG == 1
 int serprog_init(void);
@@ -800,4 +848,10 @@ static inline bool spi_master_4ba(const struct flashctx *const flash)
 		flash->mst->spi.features & SPI_MASTER_4BA;
 }
 
+static inline bool spi_master_async_read(const struct flashctx *const flash)
+{
+	return flash->mst->buses_supported & BUS_SPI &&
+		flash->mst->spi.read_submit && flash->mst->spi.read_complete;
+}
+
 #endif				/* !__PROGRAMMER_H__ */
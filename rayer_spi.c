@@ -225,7 +225,7 @@ int rayer_spi_init(void)
 	msg_pinfo("Using %s pinout.\n", prog->description);
 	pinout = (struct rayer_pinout *)prog->dev_data;
 
-	if (rget_io_perms())
+	if (rget_byte_io_perms())
 		return 1;
 
 	/* Get the initial value before writing to any line. */
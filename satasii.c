@@ -43,11 +43,12 @@ const struct dev_entry satas_sii[] = {
 
 static void satasii_chip_writeb(const struct flashctx *flash, uint8_t val, chipaddr addr);
 static uint8_t satasii_chip_readb(const struct flashctx *flash, const chipaddr addr);
+static void satasii_chip_readn(const struct flashctx *flash, uint8_t *buf, const chipaddr addr, size_t len);
 static const struct par_master par_master_satasii = {
 		.chip_readb		= satasii_chip_readb,
 		.chip_readw		= fallback_chip_readw,
 		.chip_readl		= fallback_chip_readl,
-		.chip_readn		= fallback_chip_readn,
+		.chip_readn		= satasii_chip_readn,
 		.chip_writeb		= satasii_chip_writeb,
 		.chip_writew		= fallback_chip_writew,
 		.chip_writel		= fallback_chip_writel,
@@ -74,7 +75,7 @@ int satasii_init(void)
 	uint32_t addr;
 	uint16_t reg_offset;
 
-	if (rget_io_perms())
+	if (rget_byte_io_perms())
 		return 1;
 
 	dev = pcidev_init(satas_sii, PCI_BASE_ADDRESS_0);
@@ -139,3 +140,22 @@ static uint8_t satasii_chip_readb(const struct flashctx *flash, const chipaddr a
 
 	return (pci_mmio_readl(sii_bar + 4)) & 0xff;
 }
+
+static void satasii_chip_readn(const struct flashctx *flash, uint8_t *buf, const chipaddr addr, size_t len)
+{
+	size_t i;
+	/* The control register read while waiting for a transaction also serves as base for the next one. */
+	uint32_t ctrl_reg = satasii_wait_done();
+
+	for (i = 0; i < len; i++) {
+		/* Mask out unused/reserved bits, set reads and start transaction. */
+		ctrl_reg &= 0xfcf80000;
+		ctrl_reg |= (1 << 25) | (1 << 24) | ((uint32_t)(addr + i) & 0x7ffff);
+
+		pci_mmio_writel(ctrl_reg, sii_bar);
+
+		ctrl_reg = satasii_wait_done();
+
+		buf[i] = (pci_mmio_readl(sii_bar + 4)) & 0xff;
+	}
+}
@@ -207,7 +207,7 @@ static int sfdp_fill_flash(struct flashchip *chip, uint8_t *buf, uint16_t len)
 	tmp32 |= ((unsigned int)buf[(4 * 1) + 2]) << 16;
 	tmp32 |= ((unsigned int)buf[(4 * 1) + 3]) << 24;
 
-	if (tmp32 & (1 << 31)) {
+	if (tmp32 & (1U << 31)) {
 		msg_cdbg("Flash chip size >= 4 Gb/512 MB not supported.\n");
 		return 1;
 	}
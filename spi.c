@@ -123,12 +123,79 @@ int spi_aai_write(struct flashctx *flash, const uint8_t *buf, unsigned int start
 	return flash->mst->spi.write_aai(flash, buf, start, len);
 }
 
+#define SPI_AUTOTUNE_ROUNDS	16
+#define SPI_AUTOTUNE_SFDP_LEN	16
+#define SPI_AUTOTUNE_LEN	(JEDEC_RDID_INSIZE + SPI_AUTOTUNE_SFDP_LEN)
+
+/* Reads the JEDEC ID and the start of the SFDP table, which every chip should answer in its reset state. */
+static int spi_autotune_sample(struct flashctx *flash, uint8_t *buf)
+{
+	static const unsigned char rdid[JEDEC_RDID_OUTSIZE] = { JEDEC_RDID };
+	static const unsigned char sfdp[JEDEC_SFDP_OUTSIZE] = { JEDEC_SFDP, 0, 0, 0, 0 };
+
+	if (spi_send_command(flash, sizeof(rdid), JEDEC_RDID_INSIZE, rdid, buf))
+		return 1;
+	return spi_send_command(flash, sizeof(sfdp), SPI_AUTOTUNE_SFDP_LEN, sfdp, buf + JEDEC_RDID_INSIZE);
+}
+
+/*
+ * Ramps up the SPI clock of mst until reads go wrong. set_speed(idx) selects
+ * one of count speeds, 0 being the slowest. Whatever is read at the slowest
+ * speed is the reference, every faster speed has to reproduce it in all of
+ * SPI_AUTOTUNE_ROUNDS rounds. The first failing speed ends the ramp, and the
+ * next slower one than the fastest passing is used as safety margin.
+ *
+ * Has to be called before mst is registered. Returns the index of the speed
+ * that was set, or -1 if not even the slowest speed gave usable reads.
+ */
+int spi_autotune_speed(const struct spi_master *mst, unsigned int count, int (*set_speed)(unsigned int idx))
+{
+	struct registered_master rmst = { .buses_supported = BUS_SPI, .spi = *mst };
+	struct flashctx flash = { .mst = &rmst };
+	uint8_t ref[SPI_AUTOTUNE_LEN], buf[SPI_AUTOTUNE_LEN];
+	unsigned int idx, round, best = 0;
+	bool failed = false;
+
+	if (!count || set_speed(0) || spi_autotune_sample(&flash, ref))
+		return -1;
+	/* A missing chip or a dead bus reads as all zeroes or all ones at any speed. */
+	if (!memcmp(ref, ref + 1, JEDEC_RDID_INSIZE - 1) && (ref[0] == 0x00 || ref[0] == 0xff)) {
+		msg_perr("SPI clock autotuning failed, no chip answers at the slowest speed.\n");
+		return -1;
+	}
+
+	for (idx = 0; idx < count && !failed; idx++) {
+		/* The hardware may not support all speeds, that's no read failure. */
+		if (set_speed(idx))
+			break;
+		for (round = 0; round < SPI_AUTOTUNE_ROUNDS; round++) {
+			if (spi_autotune_sample(&flash, buf) || memcmp(ref, buf, sizeof(ref))) {
+				msg_pdbg("Reads failed at speed %u in round %u.\n", idx, round);
+				failed = true;
+				break;
+			}
+		}
+		if (!failed)
+			best = idx;
+	}
+
+	if (failed && idx == 1) {
+		msg_perr("SPI clock autotuning failed, reads are unstable even at the slowest speed.\n");
+		return -1;
+	}
+	if (failed && best > 0)
+		best--;
+	if (set_speed(best))
+		return -1;
+	return best;
+}
+
 int register_spi_master(const struct spi_master *mst)
 {
 	struct registered_master rmst;
 
 	if (!mst->write_aai || !mst->write_256 || !mst->read || !mst->command ||
-	    !mst->multicommand ||
+	    !mst->multicommand || (!mst->read_submit != !mst->read_complete) ||
 	    ((mst->command == default_spi_send_command) &&
 	     (mst->multicommand == default_spi_send_multicommand))) {
 		msg_perr("%s called with incomplete master definition. "
@@ -123,6 +123,18 @@
 #define JEDEC_RDSR_OUTSIZE	0x01
 #define JEDEC_RDSR_INSIZE	0x01
 
+/* Read Macronix Security Register */
+#define MX_RDSCUR		0x2b
+#define MX_SCUR_P_FAIL		(1 << 5)
+#define MX_SCUR_E_FAIL		(1 << 6)
+
+/* Read and Clear Micron Flag Status Register */
+#define MICRON_RDFSR		0x70
+#define MICRON_CLFSR		0x50
+#define MICRON_FSR_PROT_ERR	(1 << 1)
+#define MICRON_FSR_PROG_ERR	(1 << 4)
+#define MICRON_FSR_ERASE_ERR	(1 << 5)
+
 /* Read Winbond Status Register */
 #define WINBOND_RDSR_1  JEDEC_RDSR
 #define WINBOND_RDSR_2  0x35
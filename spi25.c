@@ -23,6 +23,7 @@
  */
 
 #include <stddef.h>
+#include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
 #include "flash.h"
@@ -303,14 +304,79 @@ int probe_spi_at25f(struct flashctx *flash)
 	return 0;
 }
 
+/* Reads a one byte flag register, returns the master's error if it can't send the command. */
+static int spi_read_flag_register(struct flashctx *const flash, const uint8_t op, uint8_t *const flags)
+{
+	const unsigned char cmd[] = { op };
+
+	return spi_send_command(flash, sizeof(cmd), sizeof(*flags), cmd, flags);
+}
+
+/* Checks the chip's program/erase failure flags, if it has any. */
+static int spi_check_error_status(struct flashctx *const flash)
+{
+	const int feature_bits = flash->chip->feature_bits;
+	int ret;
+
+	if (flash->error_status_unavailable)
+		return 0;
+
+	if (feature_bits & FEATURE_ERR_SCUR) {
+		/* The fail flags are cleared by the next program or erase command. */
+		uint8_t scur;
+		ret = spi_read_flag_register(flash, MX_RDSCUR, &scur);
+		if (ret == SPI_INVALID_OPCODE)
+			goto unavailable;
+		if (ret) {
+			msg_cerr("Reading the security register failed.\n");
+			return ret;
+		}
+		if (scur & (MX_SCUR_P_FAIL | MX_SCUR_E_FAIL)) {
+			msg_cerr("Chip reports a %s failure (SCUR=0x%02x).\n",
+				 scur & MX_SCUR_E_FAIL ? "erase" : "program", scur);
+			return SPI_GENERIC_ERROR;
+		}
+	}
+	if (feature_bits & FEATURE_ERR_FSR) {
+		uint8_t fsr;
+		ret = spi_read_flag_register(flash, MICRON_RDFSR, &fsr);
+		if (ret == SPI_INVALID_OPCODE)
+			goto unavailable;
+		if (ret) {
+			msg_cerr("Reading the flag status register failed.\n");
+			return ret;
+		}
+		if (fsr & (MICRON_FSR_PROT_ERR | MICRON_FSR_PROG_ERR | MICRON_FSR_ERASE_ERR)) {
+			msg_cerr("Chip reports a %s failure (FSR=0x%02x).\n",
+				 fsr & MICRON_FSR_PROT_ERR ? "protection" :
+				 fsr & MICRON_FSR_ERASE_ERR ? "erase" : "program", fsr);
+			/* The error bits stick until cleared and would block further operations. */
+			const unsigned char cmd[] = { MICRON_CLFSR };
+			spi_send_command(flash, sizeof(cmd), 0, cmd, NULL);
+			return SPI_GENERIC_ERROR;
+		}
+	}
+	if (feature_bits & (FEATURE_ERR_SCUR | FEATURE_ERR_FSR))
+		flash->error_status_checked = true;
+	return 0;
+
+unavailable:
+	/* Without the flags, erased blocks are read back like on any other chip. */
+	msg_cdbg("The programmer can't read the chip's error flags, not relying on them.\n");
+	flash->error_status_unavailable = true;
+	return 0;
+}
+
 static int spi_poll_wip(struct flashctx *const flash, const unsigned int poll_delay)
 {
 	/* FIXME: We can't tell if spi_read_status_register() failed. */
 	/* FIXME: We don't time out. */
-	while (spi_read_status_register(flash, JEDEC_RDSR) & SPI_SR_WIP)
-		programmer_delay(poll_delay);
-	/* FIXME: Check the status register for errors. */
-	return 0;
+	if (!flash->spi_wip_clear) {
+		while (spi_read_status_register(flash, JEDEC_RDSR) & SPI_SR_WIP)
+			programmer_delay(poll_delay);
+	}
+	flash->spi_wip_clear = false;
+	return spi_check_error_status(flash);
 }
 
 /**
@@ -652,10 +718,122 @@ int spi_nbyte_read(struct flashctx *flash, unsigned int address, uint8_t *bytes,
 	return spi_send_command(flash, 1 + addr_len, len, cmd, bytes);
 }
 
+static int spi_prepare_read_request(struct flashctx *flash, struct spi_read_request *req,
+				    unsigned int address, uint8_t *bytes, unsigned int len)
+{
+	const bool native_4ba =	flash->chip->feature_bits & FEATURE_4BA_READ && spi_master_4ba(flash);
+
+	req->writearr[0] = native_4ba ? JEDEC_READ_4BA : JEDEC_READ;
+	const int addr_len = spi_prepare_address(flash, req->writearr, native_4ba, address);
+	if (addr_len < 0)
+		return 1;
+
+	req->writecnt = 1 + addr_len;
+	req->readcnt = len;
+	req->readarr = bytes;
+	return 0;
+}
+
+/*
+ * Read a part of the flash chip with the asynchronous read interface of the
+ * master, keeping up to max_reads_queued reads of chunksize bytes in flight.
+ *
+ * If buf is set, data is read directly into it. Otherwise, it is staged in a
+ * ring of max_reads_queued chunks, so memory use is bounded by the window.
+ * Either way, each completed chunk is handed to consume (if set) in order.
+ *
+ * Queued reads never span two areas, as switching areas may require a
+ * synchronous write of the extended address register.
+ */
+static int spi_read_queued(struct flashctx *flash, uint8_t *buf, unsigned int start, unsigned int len,
+			   unsigned int chunksize, spi_read_consumer_t consume, void *data)
+{
+	const struct spi_master *const mst = &flash->mst->spi;
+	const unsigned int depth = mst->max_reads_queued ? mst->max_reads_queued : SPI_READ_QUEUE_DEPTH;
+	/* Limit for multi-die 4-byte-addressing chips. */
+	const unsigned int area_size = min(flash->chip->total_size * 1024, 16 * 1024 * 1024);
+	const unsigned int end = start + len;
+	unsigned int submitted = 0, completed = 0;
+	unsigned int next = start, done = start;
+	int ret = 0;
+
+	struct spi_read_request *const reqs = calloc(depth, sizeof(*reqs));
+	uint8_t *const ring = buf ? NULL : malloc(depth * chunksize);
+	if (!reqs || (!buf && !ring)) {
+		msg_gerr("Out of memory!\n");
+		ret = 1;
+		goto _free_ret;
+	}
+
+	while (done < end) {
+		/* Fill the window as long as we stay in the area of the oldest pending read. */
+		while (!ret && next < end && submitted - completed < depth &&
+		       (submitted == completed || next / area_size == done / area_size)) {
+			struct spi_read_request *const req = &reqs[submitted % depth];
+			const unsigned int area_end = min(end, (next / area_size + 1) * area_size);
+			const unsigned int toread = min(chunksize, area_end - next);
+			uint8_t *const dst = buf ? buf + next - start : ring + submitted % depth * chunksize;
+
+			ret = spi_prepare_read_request(flash, req, next, dst, toread);
+			if (!ret)
+				ret = mst->read_submit(flash, req);
+			if (ret)
+				break;
+			++submitted;
+			next += toread;
+		}
+		/* On errors, only drain what is still in flight. */
+		if (submitted == completed)
+			break;
+
+		struct spi_read_request *const req = &reqs[completed++ % depth];
+		if (mst->read_complete(flash, req)) {
+			msg_cerr("%s: read failed at 0x%x\n", __func__, done);
+			ret = 1;
+		}
+		if (!ret && consume)
+			ret = consume(data, req->readarr, done, req->readcnt);
+		done += req->readcnt;
+	}
+
+_free_ret:
+	free(ring);
+	free(reqs);
+	return ret;
+}
+
+/* Returns true if spi_read_pipelined() can queue reads for this chip. */
+bool spi_can_read_pipelined(const struct flashctx *flash)
+{
+	return spi_master_async_read(flash) && flash->chip->read == spi_chip_read &&
+	       flash->mst->spi.read == default_spi_read &&
+	       flash->mst->spi.max_data_read != MAX_DATA_UNSPECIFIED;
+}
+
+/*
+ * Read a part of the flash chip and hand it in order to `consume` in chunks
+ * of the master's max_data_read size, keeping multiple reads in flight.
+ * Only the window of queued reads is buffered, regardless of `len`.
+ * Check spi_can_read_pipelined() first.
+ */
+int spi_read_pipelined(struct flashctx *flash, unsigned int start, unsigned int len,
+		       spi_read_consumer_t consume, void *data)
+{
+	if (!spi_can_read_pipelined(flash)) {
+		msg_perr("%s called, but not supported by this chip/programmer combination. "
+			 "Please report a bug at flashrom@flashrom.org\n", __func__);
+		return 1;
+	}
+	if (!len)
+		return 0;
+	return spi_read_queued(flash, NULL, start, len, flash->mst->spi.max_data_read, consume, data);
+}
+
 /*
  * Read a part of the flash chip.
  * FIXME: Use the chunk code from Michael Karcher instead.
  * Each naturally aligned area is read separately in chunks with a maximum size of chunksize.
+ * If the master supports it, multiple chunks are kept in flight.
  */
 int spi_read_chunked(struct flashctx *flash, uint8_t *buf, unsigned int start,
 		     unsigned int len, unsigned int chunksize)
@@ -665,6 +843,11 @@ int spi_read_chunked(struct flashctx *flash, uint8_t *buf, unsigned int start,
 	/* Limit for multi-die 4-byte-addressing chips. */
 	unsigned int area_size = min(flash->chip->total_size * 1024, 16 * 1024 * 1024);
 
+	if (!len)
+		return 0;
+	if (spi_master_async_read(flash))
+		return spi_read_queued(flash, buf, start, len, chunksize, NULL, NULL);
+
 	/* Warning: This loop has a very unusual condition and body.
 	 * The loop needs to go through each area with at least one affected
 	 * byte. The lowest area number is (start / area_size) since that
@@ -0,0 +1,205 @@
+#!/bin/sh
+#
+# This file is part of the flashrom project.
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# This script exercises the erase/write engine against the chips emulated by
+# the dummy programmer. Unlike flashrom_partial_write_test.sh it needs no
+# hardware and no second flashrom binary, so it can be run after every change.
+#
+# Each test writes a modified image, optionally restricted to layout regions,
+# and checks that exactly the requested bytes changed. The SPI operation
+# counts reported by the dummy programmer are compared against a baseline
+# file and any increase is reported as a failure.
+#
+# Usage: flashrom_dummy_write_test.sh [-u]
+#   -u  rewrite the baseline with the counts of this run
+
+EXIT_SUCCESS=0
+EXIT_FAILURE=1
+
+# The copy of flashrom to test. If unset, we'll assume the user wants to test
+# a newly built flashrom binary in the parent directory (this script should
+# reside in flashrom/util).
+if [ -z "$FLASHROM" ] ; then
+	FLASHROM="../flashrom"
+fi
+FLASHROM=$(cd "$(dirname "$FLASHROM")" && pwd)/$(basename "$FLASHROM")
+echo "testing flashrom binary: ${FLASHROM}"
+
+if [ -z "$BASELINE" ] ; then
+	BASELINE="$(cd "$(dirname "$0")" && pwd)/flashrom_dummy_write_test.baseline"
+fi
+
+UPDATE=0
+if [ "$1" = "-u" ] ; then
+	UPDATE=1
+fi
+
+TMPDIR=$(mktemp -d -t flashrom_test.XXXXXXXXXX)
+if [ "$?" != "0" ] ; then
+	echo "Could not create temporary directory"
+	exit $EXIT_FAILURE
+fi
+trap 'rm -rf "$TMPDIR"' EXIT
+cd "$TMPDIR"
+
+# 64 kB of an incrementing byte pattern and the same shifted by one byte.
+i=0
+while [ $i -lt 256 ] ; do
+	printf "\\$(printf %03o $i)"
+	i=$((i + 1))
+done > ramp_256.bin
+i=0
+while [ $i -lt 256 ] ; do
+	cat ramp_256.bin
+	i=$((i + 1))
+done > ramp.bin
+tr '\000-\377' '\001-\377\000' < ramp.bin > rramp.bin
+dd if=/dev/zero bs=1024 count=64 2>/dev/null > 00.bin
+tr '\000' '\377' < 00.bin > ff.bin
+
+# make_image <file> <size>: fill <file> with <size> bytes of ramp pattern.
+make_image()
+{
+	rm -f "$1"
+	i=0
+	while [ $i -lt $2 ] ; do
+		cat ramp.bin >> "$1"
+		i=$((i + 65536))
+	done
+}
+
+# patch_image <file> <patches>: apply "offset:length:pattern" patches, where
+# pattern is one of 00, ff or rramp. Lengths are limited to 64 kB.
+patch_image()
+{
+	for p in $2 ; do
+		off=$(($(echo "$p" | cut -d: -f1)))
+		len=$(($(echo "$p" | cut -d: -f2)))
+		pat=$(echo "$p" | cut -d: -f3)
+		dd if="${pat}.bin" of="$1" bs=1 seek=$off count=$len conv=notrunc 2>/dev/null
+	done
+}
+
+FAILED=0
+BROKEN=0
+rm -f new_baseline
+
+# run_test <name> <emulate> <chip> <size> <layout> <region> <patches> <excluded patches>
+#
+# <layout> is a layout file with ';' instead of newlines, <region> the region
+# to write. Both may be empty to write the whole chip. <excluded patches> must
+# lie outside of <region> and must not reach the chip.
+run_test()
+{
+	make_image old.bin $4
+	cp old.bin new.bin
+	patch_image new.bin "$7"
+	cp new.bin expected.bin
+	patch_image new.bin "$8"
+	cp old.bin emu.bin
+
+	if [ -n "$5" ] ; then
+		echo "$5" | tr ';' '\n' > layout.txt
+		set -- "$@" -l layout.txt -i "$6"
+	fi
+	name=$1 emulate=$2 chip=$3
+	shift 8
+
+	"$FLASHROM" -p dummy:emulate=${emulate},image=emu.bin -c "$chip" -w new.bin "$@" -V > "${name}.log" 2>&1
+	if [ "$?" != "0" ] ; then
+		echo "${name}: FAILED, flashrom returned an error (log follows)"
+		tail -n 20 "${name}.log"
+		FAILED=1
+		BROKEN=1
+		return
+	fi
+	if ! cmp -s emu.bin expected.bin ; then
+		echo "${name}: FAILED, chip contents differ from the expected image"
+		FAILED=1
+		BROKEN=1
+		return
+	fi
+
+	counts=$(sed -n 's/^Dummy SPI statistics: \([0-9]*\) commands, \([0-9]*\) bytes, \([0-9]*\) reads, \([0-9]*\) erases, \([0-9]*\) programs, \([0-9]*\) status polls$/\1 \2 \3 \4 \5 \6/p' "${name}.log")
+	echo "$name $counts" >> new_baseline
+	base=$(grep "^${name} " "$BASELINE" 2>/dev/null | cut -d' ' -f2-)
+	if [ -z "$base" ] ; then
+		echo "${name}: passed, no baseline (${counts})"
+		return
+	fi
+
+	result="passed"
+	set -- $base
+	for label in commands bytes reads erases programs polls ; do
+		cur=$(echo "$counts" | cut -d' ' -f1)
+		counts=$(echo "$counts" | cut -d' ' -f2-)
+		if [ "$cur" -gt "$1" ] ; then
+			echo "${name}: ${label} regressed from $1 to ${cur}"
+			result="FAILED"
+		elif [ "$cur" -lt "$1" ] ; then
+			echo "${name}: ${label} improved from $1 to ${cur}"
+		fi
+		shift
+	done
+	echo "${name}: ${result}"
+	if [ "$result" != "passed" ] ; then
+		FAILED=1
+	fi
+}
+
+MX25L6436="MX25L6436E/MX25L6445E/MX25L6465E/MX25L6473E/MX25L6473F"
+
+# 32 kB sectors, page programming.
+run_test m25p10_full M25P10.RES M25P10 131072 "" "" \
+	"0:65536:rramp 65536:65536:rramp" ""
+run_test m25p10_unaligned M25P10.RES M25P10 131072 \
+	"00000000:00012344 a;00012345:0001ffff b" b \
+	"0x12345:0x100:00 0x13000:0x4000:rramp 0x1ff00:0x100:ff" "0:0x1000:00 0x12300:0x45:ff"
+
+# 4/32/64 kB erase blocks, byte programming.
+run_test sst25vf040_sparse SST25VF040.REMS SST25VF040 524288 "" "" \
+	"0x1000:0x20:00 0x8000:0x10000:rramp 0x7ff00:0x100:ff" ""
+
+# 4/32/64 kB erase blocks, AAI word programming.
+run_test sst25vf032b_aai SST25VF032B SST25VF032B 4194304 "" "" \
+	"0x10001:0x1001:rramp 0x200000:0x8000:00 0x3fffff:1:ff" ""
+
+# 64 kB erase blocks only, page programming.
+run_test mx25l6405_sparse MX25L6436 MX25L6405 8388608 "" "" \
+	"0x100:0x10:00 0x40000:0x10000:rramp 0x50000:0x10000:rramp 0x7fff00:0x100:ff" ""
+
+# 4/32/64 kB erase blocks, page programming, several regions.
+run_test mx25l6436_layout MX25L6436 "$MX25L6436" 8388608 \
+	"00000000:000fffff a;00100000:007fffff b" a \
+	"0:0x1000:ff 0x80000:0x3000:rramp 0xfff00:0x100:00" "0x100000:0x1000:00 0x200000:0x8000:rramp"
+run_test mx25l6436_unaligned MX25L6436 "$MX25L6436" 8388608 \
+	"00000000:00010ffe a;00010fff:007fffff b" b \
+	"0x10fff:0x1001:00 0x20000:0x9000:rramp" "0x10f00:0xff:ff"
+
+if [ $UPDATE -eq 1 ] ; then
+	if [ $BROKEN -ne 0 ] ; then
+		echo "Not updating the baseline, some writes were incorrect."
+		exit $EXIT_FAILURE
+	fi
+	cp new_baseline "$BASELINE"
+	echo "Baseline written to ${BASELINE}"
+	exit $EXIT_SUCCESS
+fi
+
+if [ $FAILED -ne 0 ] ; then
+	echo "Test failed."
+	exit $EXIT_FAILURE
+fi
+echo "Test passed."
+exit $EXIT_SUCCESS
@@ -0,0 +1,23 @@
+/*
+ * This file is part of the flashrom project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef __FUZZ_H__
+#define __FUZZ_H__ 1
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Entry point of every fuzz target, called by libFuzzer or by fuzz_driver.c. */
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+#endif /* !__FUZZ_H__ */
@@ -0,0 +1,39 @@
+/*
+ * This file is part of the flashrom project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+/* Fuzzes cb_check_image(), which looks for coreboot IDs in an image about to be written. */
+
+#include <limits.h>
+#include "flash.h"
+#include "programmer.h"
+#include "fuzz.h"
+
+/* programmer.h declares this only for the internal programmer, which needs the libpci headers. */
+int cb_check_image(const uint8_t *bios, int size);
+
+/* cbtable.c also scans memory for the coreboot table, which is not fuzzed. */
+void *physmap_ro_unaligned(const char *descr, uintptr_t phys_addr, size_t len)
+{
+	return ERROR_PTR;
+}
+
+void physunmap_unaligned(void *virt_addr, size_t len)
+{
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	if (size <= INT_MAX)
+		cb_check_image(data, size);
+	return 0;
+}
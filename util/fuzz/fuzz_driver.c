@@ -0,0 +1,129 @@
+/*
+ * This file is part of the flashrom project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+/*
+ * Runs a fuzz target without libFuzzer. Every file given on the command line
+ * is passed to LLVMFuzzerTestOneInput() once, e.g. to replay a corpus or a
+ * crash reproducer. With -b each input is parsed repeatedly instead and the
+ * parse time per MiB of input is printed, to compare parser changes. Results
+ * go to stderr, some targets silence stdout.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "fuzz.h"
+
+/* Minimum time each input is parsed for in benchmark mode. */
+#define BENCH_SECONDS 0.2
+
+static int read_file(const char *name, uint8_t **buf, size_t *size)
+{
+	FILE *f = fopen(name, "rb");
+	long len;
+
+	if (!f) {
+		perror(name);
+		return 1;
+	}
+	if (fseek(f, 0, SEEK_END) || (len = ftell(f)) < 0 || fseek(f, 0, SEEK_SET)) {
+		perror(name);
+		fclose(f);
+		return 1;
+	}
+	/* Exactly sized, so reads past the end are caught by sanitizers. */
+	*buf = malloc(len ? len : 1);
+	if (!*buf || fread(*buf, 1, len, f) != (size_t)len) {
+		fprintf(stderr, "%s: Reading %ld bytes failed.\n", name, len);
+		free(*buf);
+		fclose(f);
+		return 1;
+	}
+	*size = len;
+	fclose(f);
+	return 0;
+}
+
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* Parses buf until BENCH_SECONDS have passed, returns the time per run in seconds. */
+static double bench_input(const uint8_t *buf, size_t size)
+{
+	const double start = now();
+	unsigned long runs = 0, batch = 1;
+	double elapsed;
+
+	do {
+		unsigned long i;
+
+		for (i = 0; i < batch; i++)
+			LLVMFuzzerTestOneInput(buf, size);
+		runs += batch;
+		batch *= 2;
+		elapsed = now() - start;
+	} while (elapsed < BENCH_SECONDS);
+
+	return elapsed / runs;
+}
+
+int main(int argc, char *argv[])
+{
+	double total_time = 0;
+	size_t total_size = 0;
+	bool bench = false;
+	int i, ret = 0;
+
+	if (argc > 1 && !strcmp(argv[1], "-b")) {
+		bench = true;
+		argc--;
+		argv++;
+	}
+	if (argc < 2) {
+		fprintf(stderr, "Usage: %s [-b] <input file>...\n", argv[0]);
+		return 1;
+	}
+
+	for (i = 1; i < argc; i++) {
+		uint8_t *buf;
+		size_t size;
+
+		if (read_file(argv[i], &buf, &size)) {
+			ret = 1;
+			continue;
+		}
+		if (bench) {
+			const double t = bench_input(buf, size);
+
+			if (size)
+				fprintf(stderr, "%s: %zu B, %.3f us per run, %.3f ms/MiB\n", argv[i], size,
+				       t * 1e6, t * 1e3 * 1048576 / size);
+			total_time += t;
+			total_size += size;
+		} else {
+			LLVMFuzzerTestOneInput(buf, size);
+		}
+		free(buf);
+	}
+	if (bench && total_size)
+		fprintf(stderr, "Total: %zu B in %d inputs, %.3f ms/MiB\n", total_size, argc - 1,
+		       total_time * 1e3 * 1048576 / total_size);
+	return ret;
+}
@@ -0,0 +1,50 @@
+/*
+ * This file is part of the flashrom project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+/* Fuzzes read_ich_descriptors_from_dump() and the printing of what it found. */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ich_descriptors.h"
+#include "fuzz.h"
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	enum ich_chipset cs = CHIPSET_ICH_UNKNOWN;
+	struct ich_descriptors desc;
+	uint32_t *dump;
+
+	/* The pretty printers write to stdout in this build. */
+	static bool quiet = false;
+	if (!quiet) {
+		if (!freopen("/dev/null", "w", stdout))
+			abort();
+		quiet = true;
+	}
+
+	/* The parser takes the dump as dwords. Allocate only what is needed, so reads past the end are caught. */
+	dump = malloc(size ? (size + 3) & ~(size_t)3 : 1);
+	if (!dump)
+		abort();
+	memset(dump, 0xff, (size + 3) & ~(size_t)3);
+	memcpy(dump, data, size);
+
+	memset(&desc, 0, sizeof(desc));
+	if (read_ich_descriptors_from_dump(dump, size, &cs, &desc) == ICH_RET_OK)
+		prettyprint_ich_descriptors(cs, &desc);
+
+	free(dump);
+	return 0;
+}
@@ -0,0 +1,40 @@
+/*
+ * This file is part of the flashrom project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+/* Fuzzes read_romlayout(), the parser for layout files given with -l. */
+
+#include <stdlib.h>
+#include <unistd.h>
+#include "flash.h"
+#include "layout.h"
+#include "fuzz.h"
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	/* read_romlayout() takes a file name, so the input goes through a temporary file. */
+	char path[] = "/tmp/fuzz_layout.XXXXXX";
+	const int fd = mkstemp(path);
+
+	if (fd < 0)
+		abort();
+	if (write(fd, data, size) != (ssize_t)size) {
+		unlink(path);
+		abort();
+	}
+	close(fd);
+
+	get_global_layout()->num_entries = 0;
+	read_romlayout(path);
+	unlink(path);
+	return 0;
+}
@@ -0,0 +1,91 @@
+/*
+ * This file is part of the flashrom project.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+/* Fuzzes probe_spi_sfdp(). The input is the SFDP address space of an emulated chip. */
+
+#include <string.h>
+#include "flash.h"
+#include "chipdrivers.h"
+#include "spi.h"
+#include "fuzz.h"
+
+static const uint8_t *sfdp_data;
+static size_t sfdp_size;
+
+/* Answers RDSFDP from the fuzz input, like a chip would. Anything else is not expected here. */
+int spi_send_command(struct flashctx *flash, unsigned int writecnt, unsigned int readcnt,
+		     const unsigned char *writearr, unsigned char *readarr)
+{
+	uint32_t addr;
+	unsigned int i;
+
+	if (writecnt != JEDEC_SFDP_OUTSIZE - 1 || writearr[0] != JEDEC_SFDP)
+		return SPI_INVALID_OPCODE;
+
+	addr = writearr[1] << 16 | writearr[2] << 8 | writearr[3];
+	/* The first byte read is the dummy byte. */
+	for (i = 0; i < readcnt; i++)
+		readarr[i] = i && addr + i - 1 < sfdp_size ? sfdp_data[addr + i - 1] : 0xff;
+	return 0;
+}
+
+/* Only the addresses of these matter to the SFDP parser. */
+int spi_chip_write_1(struct flashctx *flash, const uint8_t *buf, unsigned int start, unsigned int len)
+{
+	return 1;
+}
+
+int spi_chip_write_256(struct flashctx *flash, const uint8_t *buf, unsigned int start, unsigned int len)
+{
+	return 1;
+}
+
+static int erase_stub(struct flashctx *flash, unsigned int addr, unsigned int blocklen)
+{
+	return 1;
+}
+
+static int erase_stub_other(struct flashctx *flash, unsigned int addr, unsigned int blocklen)
+{
+	return 1;
+}
+
+/* Like the real one, returns NULL for unknown opcodes. Different opcodes may map to different erasers. */
+erasefunc_t *spi_get_erasefn_from_opcode(uint8_t opcode)
+{
+	switch (opcode) {
+	case 0x20:
+	case 0x52:
+	case 0x81:
+		return &erase_stub;
+	case 0xd7:
+	case 0xd8:
+	case 0x60:
+	case 0xc7:
+		return &erase_stub_other;
+	default:
+		return NULL;
+	}
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	struct flashchip chip;
+	struct flashctx flash = { .chip = &chip };
+
+	memset(&chip, 0, sizeof(chip));
+	sfdp_data = data;
+	sfdp_size = size;
+	probe_spi_sfdp(&flash);
+	return 0;
+}
@@ -67,6 +67,8 @@ static int wbsio_spi_send_command(struct flashctx *flash, unsigned int writecnt,
 				  unsigned char *readarr);
 static int wbsio_spi_read(struct flashctx *flash, uint8_t *buf,
 			  unsigned int start, unsigned int len);
+static int wbsio_spi_write_256(struct flashctx *flash, const uint8_t *buf,
+			       unsigned int start, unsigned int len);
 
 static const struct spi_master spi_master_wbsio = {
 	.type = SPI_CONTROLLER_WBSIO,
@@ -75,7 +77,7 @@ static const struct spi_master spi_master_wbsio = {
 	.command = wbsio_spi_send_command,
 	.multicommand = default_spi_send_multicommand,
 	.read = wbsio_spi_read,
-	.write_256 = spi_chip_write_1,
+	.write_256 = wbsio_spi_write_256,
 	.write_aai = default_spi_write_aai,
 };
 
@@ -208,4 +210,25 @@ static int wbsio_spi_read(struct flashctx *flash, uint8_t *buf,
 	return 0;
 }
 
+/*
+ * Mode 6 programs four bytes at once. Use it for the 4-byte aligned part of
+ * the range and byte programming (mode 5) for the unaligned head and tail.
+ * Page sizes are multiples of four, so no 4-byte chunk crosses a page.
+ */
+static int wbsio_spi_write_256(struct flashctx *flash, const uint8_t *buf,
+			       unsigned int start, unsigned int len)
+{
+	const unsigned int head = min(len, (4 - (start & 3)) & 3);
+	const unsigned int body = (len - head) & ~3;
+	const unsigned int tail = len - head - body;
+
+	if (head && spi_chip_write_1(flash, buf, start, head))
+		return 1;
+	if (body && spi_write_chunked(flash, buf + head, start + head, body, 4))
+		return 1;
+	if (tail && spi_chip_write_1(flash, buf + head + body, start + head + body, tail))
+		return 1;
+	return 0;
+}
+
 #endif